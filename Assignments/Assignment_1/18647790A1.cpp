@@ -2,155 +2,1719 @@
 // Student Number: 18647790A1
 
 #include <iostream>  // for standard input and output (like cout and cerr)
-#include <fstream>  // for reading from files
-#include <sstream> // for breaking strings into parts
-#include <queue> // for using queues (FIFO structure)
+#include <algorithm> // for min, max and upper_bound
+#include <sstream> // for formatting numbers in the summary
+#include <queue> // for the priority queue used as the event calendar (and std::queue in the queue benchmark)
+#include <string> // for route names
+#include <unordered_map> // for looking up routes by name
 #include <vector> // for using vectors (dynamic arrays)
-#include <map> // for key-value pairs to store passenger arrivals by time
 #include <iomanip> // for formatting output (like setw)
+#include <cstdio> // for FILE* block reads when the file cannot be memory-mapped
+#include <cstring> // for memchr, memmove and strlen
+#include <climits> // for INT_MAX
+#include <functional> // for greater<> in the event calendar
+#include <cstdlib> // for atoi when reading command-line options
+#include <cctype> // for isspace
+#include <chrono> // for timing the queue benchmark
+#include <random> // for synthetic arrival scenarios
+#include <cmath> // for ceil and log in the arrival generator
+#include <cstdint> // for fixed-width seeds
+#include <thread> // for running scenarios on all cores
+#include <mutex> // for the work-stealing task queues
+#include <deque> // for the per-worker task queues
+#include <memory> // for unique_ptr
+
+// Memory-mapped reading of the data file is available on Linux/Mac
+#if defined(__unix__) || defined(__APPLE__)
+#define TAXI_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Wait-time and taxi fill-time histograms; build with -DTAXI_METRICS=0 to remove them entirely
+#ifndef TAXI_METRICS
+#define TAXI_METRICS 1
+#endif
 
 using namespace std;
 
 // Structure to represent a passenger
 struct Passenger {
-    char route;
+    int route;        // dense route id from the TaxiRank route table
     int boardingTime;
+    int arrivalTime;  // time step the passenger joined the queue
 };
 
-// Structure to represent a taxi
-struct Taxi {
-    int capacity = 0; // number of available seats (max is 5)
-    bool isBoarding = false; // is someone currently boarding this taxi?
-    int remainingBoardTime = 0; // countdown for how long the current passenger takes to board
-    bool justLeft = false;  // did the taxi just leave and we’re waiting for a new one?
+// Statistics for one route, collected the same way by both simulation engines
+struct RouteStats {
+    long long boarded = 0;    // passengers that finished boarding
+    long long departures = 0; // taxis that filled up and left
+    long long waitTicks = 0;  // sum of the "WaitQ" column over all time steps
+    int peakWait = 0;         // largest "WaitQ" value seen
 };
 
-// Function to read the data file and return a map of time to passengers arriving then
-map<int, vector<Passenger>> readPassengerData(const string& filePath) {
-    ifstream file(filePath); // try open the file
-    map<int, vector<Passenger>> arrivals; // map to hold passengers by arrival time
+// Log-linear ("HDR-style") histograms of non-negative ints, one per route, in one flat array.
+// Values below 64 have a bucket each; above that every power of two is split into 32 buckets,
+// so a percentile is off by at most about 3% and any int fits in 864 counters per route.
+// Recording a value is one bucket calculation and one increment.
+class RouteHistograms {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB = 1 << SUB_BITS;
+    static const int BUCKETS = (31 - SUB_BITS + 1) * SUB;
+
+    int routeCount() const { return (int)(counts.size() / BUCKETS); }
+    void addRoute() { counts.resize(counts.size() + BUCKETS, 0); }
+
+    void record(int route, int value) {
+        counts[(size_t)route * BUCKETS + bucketOf(value)]++;
+    }
+
+    long long total(int route) const {
+        long long n = 0;
+        for (int i = 0; i < BUCKETS; ++i) n += counts[(size_t)route * BUCKETS + i];
+        return n;
+    }
+
+    // Smallest value v such that at least 'fraction' of the recorded values are <= v
+    // (reported as the top of its bucket); -1 if the route has no values
+    int percentile(int route, double fraction) const {
+        long long n = total(route);
+        if (n == 0) return -1;
+        long long need = max(1LL, (long long)ceil(fraction * n));
+        long long seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[(size_t)route * BUCKETS + i];
+            if (seen >= need) return bucketTop(i);
+        }
+        return bucketTop(BUCKETS - 1);
+    }
+
+    // Add another set of histograms route by route
+    void merge(const RouteHistograms& other) {
+        if (counts.size() < other.counts.size()) counts.resize(other.counts.size(), 0);
+        for (size_t i = 0; i < other.counts.size(); ++i) counts[i] += other.counts[i];
+    }
+
+    // Direct access to one counter (used by snapshots)
+    long long& at(int route, int bucket) { return counts[(size_t)route * BUCKETS + bucket]; }
+    long long at(int route, int bucket) const { return counts[(size_t)route * BUCKETS + bucket]; }
+
+    // All routes folded into one histogram (route 0 of the result)
+    RouteHistograms combined() const {
+        RouteHistograms all;
+        all.addRoute();
+        for (size_t i = 0; i < counts.size(); ++i) all.counts[i % BUCKETS] += counts[i];
+        return all;
+    }
+
+    static int bucketOf(int v) {
+        if (v < 2 * SUB) return max(v, 0);
+        int msb = 0;
+#if defined(__GNUC__)
+        msb = 31 - __builtin_clz((unsigned)v);
+#else
+        while ((v >> (msb + 1)) != 0) ++msb;
+#endif
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB + ((v >> shift) - SUB);
+    }
+
+    // Largest value that falls in bucket i
+    static int bucketTop(int i) {
+        if (i < 2 * SUB) return i;
+        int shift = i / SUB - 1;
+        long long top = ((long long)(i % SUB + SUB + 1) << shift) - 1;
+        return (int)min<long long>(top, INT_MAX);
+    }
+
+private:
+    vector<long long> counts;
+};
+
+// ------------------------------ Taxi Rank State ------------------------------
+/*
+The rank is stored as a route table plus a bay table, both as struct-of-arrays
+so the per-tick update is a single loop over contiguous vectors:
+- Routes are numbered 0..routeCount()-1 in the order they are first seen.
+  Each route owns a FIFO queue of waiting passengers and one or more bays.
+- A bay is one loading spot with its own taxi (what the Taxi struct used to
+  be): seats left, taxi size, boarding countdown and a "just left" flag.
+  The bays of a route are contiguous: [bayBegin[r], bayBegin[r] + bayCount[r]).
+- Every route queue is a ring buffer carved out of one shared arena. A ring
+  that fills up moves to a region twice its size at the end of the arena
+  (and the arena is compacted when too much of it is left-over space), so
+  the arena stops growing once the busiest moment has been seen and the
+  steady-state loop makes no allocations at all.
+*/
+class TaxiRank {
+public:
+    // Route table (indexed by route id)
+    vector<string> names;
+    vector<int> bayBegin;    // first bay of the route
+    vector<int> bayCount;    // number of bays loading in parallel
+    vector<int> ringBase;    // start of the route's ring in the arena
+    vector<int> ringMask;    // ring capacity - 1 (capacities are powers of two)
+    vector<int> ringHead;    // position of the first waiting passenger in the ring
+    vector<int> waiting;     // passengers waiting, not yet at a bay
+    vector<int> inQueue;     // waiting plus boarding (the queue column in the table)
+    vector<RouteStats> stats;
+    vector<double> arrivalRate; // expected arrivals per time step (synthetic scenarios only)
+
+    // Bay table (indexed by bay id)
+    vector<int> bayRoute;    // route the bay belongs to
+    vector<int> seats;       // seats left in the taxi at this bay
+    vector<int> taxiSize;    // seats in a fresh taxi
+    vector<int> boardLeft;   // countdown for the passenger boarding here (0 = nobody boarding)
+    vector<char> justLeft;   // did the taxi just leave and we're waiting for a new one?
+
+    int now = 0;             // time step being simulated (next one to simulate between runs)
+    int defaultBays = 1;     // used for routes that first appear in the data file
+    int defaultTaxiSize = 5;
+    double defaultRate = 0.3; // arrivals per time step for synthetic scenarios
+
+    int ticksPerHour = 60;    // time steps per hour, for the departures-per-hour figure
+
+#if TAXI_METRICS
+    RouteHistograms waitHist;  // per route: time steps from joining the queue to starting to board
+    RouteHistograms fillHist;  // per route: time steps from a taxi pulling in to leaving full
+    vector<int> taxiArrivedAt; // per bay: when the current taxi pulled in
+#endif
+
+    TaxiRank() {
+        for (int& r : byLetter) r = -1;
+    }
+
+    int routeCount() const { return (int)names.size(); }
+    int totalBays() const { return (int)bayRoute.size(); }
+
+    // Register a route with its own fleet; returns the route id
+    int addRoute(const string& name, int bays, int size) {
+        int r = routeCount();
+        names.push_back(name);
+        bayBegin.push_back(totalBays());
+        bayCount.push_back(bays);
+        ringBase.push_back((int)arena.size());
+        ringMask.push_back(INITIAL_RING - 1);
+        ringHead.push_back(0);
+        arena.resize(arena.size() + INITIAL_RING);
+        waiting.push_back(0);
+        inQueue.push_back(0);
+        stats.push_back(RouteStats());
+        arrivalRate.push_back(defaultRate);
+#if TAXI_METRICS
+        waitHist.addRoute();
+        fillHist.addRoute();
+#endif
+        for (int i = 0; i < bays; ++i) {
+            bayRoute.push_back(r);
+            // At the start every bay is empty, so its first taxi "departs" at time 0 and a
+            // full one arrives at time 1; a route first seen later already has its taxi waiting
+            seats.push_back(now == 0 ? 0 : size);
+            taxiSize.push_back(size);
+            boardLeft.push_back(0);
+            justLeft.push_back(0);
+#if TAXI_METRICS
+            taxiArrivedAt.push_back(now == 0 ? 1 : now);
+#endif
+        }
+        if (name.size() == 1) byLetter[(unsigned char)name[0]] = r;
+        else byName[name] = r;
+        return r;
+    }
+
+    // Look up a route by name, adding it with the default fleet if it is new
+    int routeId(const char* b, const char* e) {
+        if (e - b == 1) {
+            int r = byLetter[(unsigned char)*b]; // one-letter routes skip hashing
+            if (r >= 0) return r;
+        } else {
+            auto it = byName.find(string(b, e));
+            if (it != byName.end()) return it->second;
+        }
+        return addRoute(string(b, e), defaultBays, defaultTaxiSize);
+    }
+
+    // Total seats left over all bays of a route (the "Cap" column)
+    int routeSeats(int r) const {
+        int total = 0;
+        for (int b = bayBegin[r]; b < bayBegin[r] + bayCount[r]; ++b) total += seats[b];
+        return total;
+    }
+
+    // Instrumentation hooks called by both engines at the current time 'now'
+    // (they compile to nothing without TAXI_METRICS)
+    void recordBoardingStart(const Passenger& p) {
+#if TAXI_METRICS
+        waitHist.record(p.route, now - p.arrivalTime);
+#else
+        (void)p;
+#endif
+    }
+    void recordTaxiArrival(int bay) {
+#if TAXI_METRICS
+        taxiArrivedAt[bay] = now;
+#else
+        (void)bay;
+#endif
+    }
+    void recordDeparture(int bay) {
+#if TAXI_METRICS
+        fillHist.record(bayRoute[bay], now - taxiArrivedAt[bay]);
+#else
+        (void)bay;
+#endif
+    }
+
+    // Add a passenger to the back of their route queue
+    void enqueue(const Passenger& p) {
+        int r = p.route;
+        if (waiting[r] > ringMask[r]) growRing(r);
+        arena[ringBase[r] + ((ringHead[r] + waiting[r]) & ringMask[r])] = p;
+        waiting[r]++;
+        inQueue[r]++;
+    }
+
+    // Remove the passenger at the front of a route queue (the queue must not be empty)
+    Passenger dequeue(int r) {
+        Passenger p = arena[ringBase[r] + ringHead[r]];
+        ringHead[r] = (ringHead[r] + 1) & ringMask[r];
+        waiting[r]--;
+        return p;
+    }
+
+    // The i-th waiting passenger of a route (0 = front of the queue)
+    const Passenger& waitingAt(int r, int i) const {
+        return arena[ringBase[r] + ((ringHead[r] + i) & ringMask[r])];
+    }
+
+    long long ringGrowths = 0; // how often a ring had to move to a bigger region
+
+private:
+    static const int INITIAL_RING = 4;
 
-    if (!file.is_open()) {
-        cerr << "ERROR: Could not open file at path: " << filePath << endl;
-        return arrivals; // return empty map if failed
+    vector<Passenger> arena; // storage shared by all route rings
+    size_t unusedSlots = 0;  // arena slots left behind by rings that moved
+
+    // Move a full ring to a region twice its size at the end of the arena
+    void growRing(int r) {
+        if (unusedSlots * 2 > arena.size()) compactArena();
+        int oldCap = ringMask[r] + 1;
+        int newBase = (int)arena.size();
+        arena.resize(arena.size() + 2 * oldCap);
+        for (int i = 0; i < waiting[r]; ++i) {
+            arena[newBase + i] = arena[ringBase[r] + ((ringHead[r] + i) & ringMask[r])];
+        }
+        unusedSlots += oldCap;
+        ringBase[r] = newBase;
+        ringMask[r] = 2 * oldCap - 1;
+        ringHead[r] = 0;
+        ringGrowths++;
     }
 
-    string line;
-    while (getline(file, line)) {
-        stringstream ss(line);  // used to split the line by commas
-        string timeStr, routeStr, boardStr;
+    // Pack every ring next to each other again, dropping the left-over regions
+    void compactArena() {
+        vector<Passenger> packed;
+        packed.reserve(arena.size() - unusedSlots + arena.size() / 2); // room for the grow that follows
+        for (int r = 0; r < routeCount(); ++r) {
+            int base = (int)packed.size();
+            packed.insert(packed.end(), arena.begin() + ringBase[r], arena.begin() + ringBase[r] + ringMask[r] + 1);
+            ringBase[r] = base;
+        }
+        arena.swap(packed);
+        unusedSlots = 0;
+    }
 
-        // Extract time, route and boarding time
-        getline(ss, timeStr, ',');
-        getline(ss, routeStr, ',');
-        getline(ss, boardStr, ',');
+    int byLetter[256];       // route id for one-letter names (-1 if unknown)
+    unordered_map<string, int> byName;
+};
 
-        // Convert string values to appropriate data types
-        int time = stoi(timeStr); // convert to integer
-        char route = routeStr[0]; // get the first char
-        int boardTime = stoi(boardStr); // convert to integer
+// --------------------------------- Snapshots ----------------------------------
+/*
+A snapshot holds the complete TaxiRank state: clock, route table, everything in
+the queues and at the bays, the statistics and (with TAXI_METRICS) the
+histograms. A later run can load it and continue from 'now' with only the new
+arrivals, instead of replaying the whole day. Layout (native byte order):
+  "TAXISNP1"
+  int32 now, defaultBays, defaultTaxiSize, ticksPerHour; double defaultRate
+  uint32 routes, then per route:
+    string name (uint32 length + bytes), int32 bays, double rate,
+    int64 boarded, departures, waitTicks; int32 peakWait, inQueue,
+    int32 waiting, then waiting x (int32 boardingTime, int32 arrivalTime),
+    per bay: int32 taxiSize, seats, boardLeft, taxiArrivedAt; uint8 justLeft
+  uint8 hasMetrics; if set, for the wait and then the fill histograms:
+    uint32 non-zero buckets, then (uint32 route, uint32 bucket, int64 count)
+Queues are stored front to back, not in arena layout, so snapshots stay small.
+*/
 
-        // Add this passenger to the correct time slot
-        arrivals[time].push_back({route, boardTime});
+class SnapshotWriter {
+public:
+    template <class T> void put(T v) {
+        const char* p = (const char*)&v;
+        bytes.insert(bytes.end(), p, p + sizeof(T));
     }
+    void putString(const string& text) {
+        put<uint32_t>((uint32_t)text.size());
+        bytes.insert(bytes.end(), text.begin(), text.end());
+    }
+    const vector<char>& data() const { return bytes; }
+private:
+    vector<char> bytes;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const vector<char>& snapshot) : bytes(snapshot) {}
+    bool ok() const { return good; }
+    size_t remaining() const { return bytes.size() - pos; }
 
-    return arrivals;
+    template <class T> T get() {
+        T v = T();
+        if (remaining() < sizeof(T)) {
+            good = false;
+            return v;
+        }
+        memcpy(&v, bytes.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    string getString() {
+        uint32_t len = get<uint32_t>();
+        if (!good || remaining() < len) {
+            good = false;
+            return string();
+        }
+        string text(bytes.data() + pos, len);
+        pos += len;
+        return text;
+    }
+private:
+    const vector<char>& bytes;
+    size_t pos = 0;
+    bool good = true;
+};
+
+#if TAXI_METRICS
+void putHistograms(SnapshotWriter& w, const RouteHistograms& hist) {
+    uint32_t nonZero = 0;
+    for (int r = 0; r < hist.routeCount(); ++r)
+        for (int i = 0; i < RouteHistograms::BUCKETS; ++i) nonZero += hist.at(r, i) != 0;
+    w.put<uint32_t>(nonZero);
+    for (int r = 0; r < hist.routeCount(); ++r) {
+        for (int i = 0; i < RouteHistograms::BUCKETS; ++i) {
+            if (hist.at(r, i) == 0) continue;
+            w.put<uint32_t>((uint32_t)r);
+            w.put<uint32_t>((uint32_t)i);
+            w.put<int64_t>(hist.at(r, i));
+        }
+    }
 }
+#endif
 
-// Function to print the table headers for each time step
-void printHeader() {
-    cout << left << setw(6) << "Time"
-         << setw(20) << "New Arrivals"
-         << setw(6) << "S" << setw(6) << "L" << setw(6) << "C"
-         << setw(12) << "WaitQ S" << setw(12) << "WaitQ L" << setw(12) << "WaitQ C"
-         << setw(10) << "Cap S" << setw(10) << "Cap L" << setw(10) << "Cap C" << endl;
-    cout << string(100, '-') << endl; // line separator
+// Read the histograms section (into 'hist' when it is not null)
+bool getHistograms(SnapshotReader& rd, RouteHistograms* hist, int routes) {
+    uint32_t nonZero = rd.get<uint32_t>();
+    for (uint32_t k = 0; k < nonZero && rd.ok(); ++k) {
+        uint32_t r = rd.get<uint32_t>();
+        uint32_t i = rd.get<uint32_t>();
+        int64_t count = rd.get<int64_t>();
+        if (r >= (uint32_t)routes || i >= (uint32_t)RouteHistograms::BUCKETS) return false;
+        if (hist) hist->at((int)r, (int)i) = count;
+    }
+    return rd.ok();
 }
 
-// Function that simulates the entire taxi rank system over time
-void simulateTaxiRank(map<int, vector<Passenger>>& arrivals, int maxTime = 25) {
-    // Queues for each route
-    queue<Passenger> queueS, queueL, queueC;
-    Taxi taxiS, taxiL, taxiC; // taxis for each route
+// Write the rank to 'path' (via a temporary file, so a crash never leaves half a snapshot)
+bool saveSnapshot(const TaxiRank& rank, const string& path) {
+    SnapshotWriter w;
+    const char magic[8] = { 'T', 'A', 'X', 'I', 'S', 'N', 'P', '1' };
+    for (char c : magic) w.put<char>(c);
+    w.put<int32_t>(rank.now);
+    w.put<int32_t>(rank.defaultBays);
+    w.put<int32_t>(rank.defaultTaxiSize);
+    w.put<int32_t>(rank.ticksPerHour);
+    w.put<double>(rank.defaultRate);
+
+    w.put<uint32_t>((uint32_t)rank.routeCount());
+    for (int r = 0; r < rank.routeCount(); ++r) {
+        const RouteStats& st = rank.stats[r];
+        w.putString(rank.names[r]);
+        w.put<int32_t>(rank.bayCount[r]);
+        w.put<double>(rank.arrivalRate[r]);
+        w.put<int64_t>(st.boarded);
+        w.put<int64_t>(st.departures);
+        w.put<int64_t>(st.waitTicks);
+        w.put<int32_t>(st.peakWait);
+        w.put<int32_t>(rank.inQueue[r]);
+        w.put<int32_t>(rank.waiting[r]);
+        for (int i = 0; i < rank.waiting[r]; ++i) {
+            w.put<int32_t>(rank.waitingAt(r, i).boardingTime);
+            w.put<int32_t>(rank.waitingAt(r, i).arrivalTime);
+        }
+        for (int b = rank.bayBegin[r]; b < rank.bayBegin[r] + rank.bayCount[r]; ++b) {
+            w.put<int32_t>(rank.taxiSize[b]);
+            w.put<int32_t>(rank.seats[b]);
+            w.put<int32_t>(rank.boardLeft[b]);
+#if TAXI_METRICS
+            w.put<int32_t>(rank.taxiArrivedAt[b]);
+#else
+            w.put<int32_t>(rank.now);
+#endif
+            w.put<uint8_t>((uint8_t)rank.justLeft[b]);
+        }
+    }
+
+#if TAXI_METRICS
+    w.put<uint8_t>(1);
+    putHistograms(w, rank.waitHist);
+    putHistograms(w, rank.fillHist);
+#else
+    w.put<uint8_t>(0);
+#endif
+
+    string tmpPath = path + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) {
+        cerr << "ERROR: Could not write snapshot: " << tmpPath << endl;
+        return false;
+    }
+    bool written = fwrite(w.data().data(), 1, w.data().size(), f) == w.data().size();
+    written = fclose(f) == 0 && written;
+    remove(path.c_str()); // rename does not replace an existing file on Windows
+    if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        cerr << "ERROR: Could not write snapshot: " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+// Load a snapshot into an empty rank; returns false (and reports why) if the file is unusable
+bool loadSnapshot(TaxiRank& rank, const string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        cerr << "ERROR: Could not open snapshot: " << path << endl;
+        return false;
+    }
+    vector<char> bytes;
+    char block[1 << 16];
+    size_t got;
+    while ((got = fread(block, 1, sizeof(block), f)) > 0) bytes.insert(bytes.end(), block, block + got);
+    fclose(f);
+
+    SnapshotReader rd(bytes);
+    auto fail = [&](const char* why) {
+        cerr << "ERROR: " << path << " is not a usable snapshot: " << why << endl;
+        return false;
+    };
+    if (bytes.size() < 8 || memcmp(bytes.data(), "TAXISNP1", 8) != 0) return fail("wrong file type");
+    for (int i = 0; i < 8; ++i) rd.get<char>();
+
+    int now = rd.get<int32_t>();
+    rank.defaultBays = rd.get<int32_t>();
+    rank.defaultTaxiSize = rd.get<int32_t>();
+    rank.ticksPerHour = max(1, (int)rd.get<int32_t>());
+    rank.defaultRate = rd.get<double>();
+
+    uint32_t routes = rd.get<uint32_t>();
+    for (uint32_t k = 0; k < routes && rd.ok(); ++k) {
+        string name = rd.getString();
+        int bays = rd.get<int32_t>();
+        if (!rd.ok() || bays < 1 || (size_t)bays > rd.remaining()) return fail("bad route entry");
+        int r = rank.addRoute(name, bays, rank.defaultTaxiSize);
+        RouteStats& st = rank.stats[r];
+        rank.arrivalRate[r] = rd.get<double>();
+        st.boarded = rd.get<int64_t>();
+        st.departures = rd.get<int64_t>();
+        st.waitTicks = rd.get<int64_t>();
+        st.peakWait = rd.get<int32_t>();
+        int inQueue = rd.get<int32_t>();
+        int waiting = rd.get<int32_t>();
+        if (!rd.ok() || waiting < 0 || (size_t)waiting > rd.remaining() / 8) return fail("bad queue length");
+        for (int i = 0; i < waiting; ++i) {
+            Passenger p;
+            p.route = r;
+            p.boardingTime = rd.get<int32_t>();
+            p.arrivalTime = rd.get<int32_t>();
+            rank.enqueue(p);
+        }
+        rank.inQueue[r] = inQueue;
+        for (int b = rank.bayBegin[r]; b < rank.bayBegin[r] + bays; ++b) {
+            rank.taxiSize[b] = rd.get<int32_t>();
+            rank.seats[b] = rd.get<int32_t>();
+            rank.boardLeft[b] = rd.get<int32_t>();
+            int arrivedAt = rd.get<int32_t>();
+#if TAXI_METRICS
+            rank.taxiArrivedAt[b] = arrivedAt;
+#else
+            (void)arrivedAt;
+#endif
+            rank.justLeft[b] = (char)rd.get<uint8_t>();
+        }
+    }
+    if (!rd.ok()) return fail("file is cut short");
+
+    uint8_t hasMetrics = rd.get<uint8_t>();
+    if (hasMetrics) {
+#if TAXI_METRICS
+        RouteHistograms* waitHist = &rank.waitHist;
+        RouteHistograms* fillHist = &rank.fillHist;
+#else
+        RouteHistograms* waitHist = nullptr; // this build has no histograms: skip them
+        RouteHistograms* fillHist = nullptr;
+#endif
+        if (!getHistograms(rd, waitHist, (int)routes) || !getHistograms(rd, fillHist, (int)routes)) {
+            return fail("bad histogram section");
+        }
+    }
+    if (!rd.ok()) return fail("file is cut short");
+    rank.now = now;
+    return true;
+}
+
+// Structure to represent one row of the data file: a passenger arriving at a time
+struct Arrival {
+    int time;
+    Passenger passenger;
+};
+
+// Anything the simulation engines can pull arrivals from, in time order
+class ArrivalSource {
+public:
+    virtual ~ArrivalSource() {}
+    virtual bool next(Arrival& out) = 0; // false when there are no more arrivals
+};
+
+// Class that streams passenger arrivals out of the data file one row at a time.
+// The file is memory-mapped where the OS supports it, otherwise it is read in
+// large blocks, and each "time,route,boarding_time" row is parsed in place with
+// a small integer parser (no strings, stringstreams or stoi). Rows must be in
+// time order so the simulation can consume them as it goes; a bad row is
+// reported by line number on cerr and skipped instead of stopping the run.
+class ArrivalStream : public ArrivalSource {
+public:
+    ArrivalStream(const string& path, TaxiRank& target) : filePath(path), rank(target) {
+#ifdef TAXI_HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL); // we only read front to back
+                    mapped = p;
+                    mappedSize = (size_t)st.st_size;
+                    cur = (const char*)p;
+                    lim = cur + mappedSize;
+                    atEof = true; // the whole file is already "in the buffer"
+                }
+            } else if (fstat(fd, &st) == 0) {
+                atEof = true; // empty file: nothing to map
+            }
+            close(fd);
+            if (atEof) {
+                opened = true;
+                return;
+            }
+        }
+#endif
+        // Fallback: read the file in big blocks
+        file = fopen(path.c_str(), "rb");
+        if (!file) {
+            cerr << "ERROR: Could not open file at path: " << filePath << endl;
+            return;
+        }
+        opened = true;
+        buffer.resize(BLOCK_SIZE);
+        cur = lim = buffer.data();
+    }
+
+    ~ArrivalStream() {
+#ifdef TAXI_HAVE_MMAP
+        if (mapped) munmap(mapped, mappedSize);
+#endif
+        if (file) fclose(file);
+    }
+
+    ArrivalStream(const ArrivalStream&) = delete;
+    ArrivalStream& operator=(const ArrivalStream&) = delete;
+
+    bool isOpen() const { return opened; }
+    long long linesRead() const { return lineNo; }
+    long long malformedLines() const { return badLines; }
+
+    // Read the next valid arrival into 'out'; returns false at the end of the file
+    bool next(Arrival& out) override {
+        const char* b;
+        const char* e;
+        while (nextLine(b, e)) {
+            ++lineNo;
+            if (e > b && e[-1] == '\r') --e; // tolerate Windows line endings
+
+            const char* p = b;
+            skipSpaces(p, e);
+            if (p == e) continue; // blank lines are ignored
+
+            const char* routeBegin;
+            const char* routeEnd;
+            const char* error = parseRow(p, e, out, routeBegin, routeEnd);
+            if (!error && out.time < lastTime) error = "time goes backwards (rows must be in time order)";
+            if (!error && out.time < rank.now) error = "time is before the resumed simulation time";
+            if (error) {
+                ++badLines;
+                cerr << "WARNING: " << filePath << ":" << lineNo << ": " << error
+                     << ", skipping line \"" << string(b, e) << "\"" << endl;
+                continue;
+            }
+            out.passenger.route = rank.routeId(routeBegin, routeEnd); // only accepted rows create routes
+            lastTime = out.time;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    static const size_t BLOCK_SIZE = 1 << 20; // 1 MiB reads keep system calls rare
+
+    string filePath;
+    TaxiRank& rank;           // turns route names into route ids
+    bool opened = false;
+    FILE* file = nullptr;
+    vector<char> buffer;      // block buffer (only used when not memory-mapped)
+    const char* cur = nullptr; // next unread byte
+    const char* lim = nullptr; // end of the bytes currently available
+    bool atEof = false;
+#ifdef TAXI_HAVE_MMAP
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+#endif
+    long long lineNo = 0;
+    long long badLines = 0;
+    int lastTime = 0;
+
+    static void skipSpaces(const char*& p, const char* e) {
+        while (p < e && (*p == ' ' || *p == '\t')) ++p;
+    }
+
+    // Parse a non-negative decimal integer; returns false if there are no digits or it overflows
+    static bool parseInt(const char*& p, const char* e, int& value) {
+        const char* start = p;
+        int v = 0;
+        while (p < e && *p >= '0' && *p <= '9') {
+            int digit = *p - '0';
+            if (v > (INT_MAX - digit) / 10) return false;
+            v = v * 10 + digit;
+            ++p;
+        }
+        if (p == start) return false;
+        value = v;
+        return true;
+    }
+
+    static bool expectComma(const char*& p, const char* e) {
+        skipSpaces(p, e);
+        if (p == e || *p != ',') return false;
+        ++p;
+        skipSpaces(p, e);
+        return true;
+    }
+
+    // Parse "time,route,boarding_time"; returns nullptr on success or a description of the problem.
+    // The route name is returned as [routeBegin, routeEnd); next() turns it into an id once the
+    // row has passed every check.
+    const char* parseRow(const char* p, const char* e, Arrival& out, const char*& routeBegin, const char*& routeEnd) {
+        if (!parseInt(p, e, out.time)) return "time is not a valid number";
+        if (!expectComma(p, e)) return "expected ',' after time";
+        routeBegin = p;
+        while (p < e && *p != ',') ++p;
+        routeEnd = p;
+        while (routeEnd > routeBegin && (routeEnd[-1] == ' ' || routeEnd[-1] == '\t')) --routeEnd;
+        if (routeEnd == routeBegin) return "missing route";
+        if (!expectComma(p, e)) return "expected ',' after route";
+        if (!parseInt(p, e, out.passenger.boardingTime)) return "boarding time is not a valid number";
+        if (out.passenger.boardingTime == 0) return "boarding time must be at least 1";
+        skipSpaces(p, e);
+        if (p != e) return "unexpected text after boarding time";
+        out.passenger.arrivalTime = out.time;
+        return nullptr;
+    }
+
+    // Find the next line [b, e) without copying it; refills the block buffer when needed
+    bool nextLine(const char*& b, const char*& e) {
+        while (true) {
+            const char* nl = (const char*)memchr(cur, '\n', lim - cur);
+            if (nl) {
+                b = cur;
+                e = nl;
+                cur = nl + 1;
+                return true;
+            }
+            if (atEof || !refill()) {
+                if (cur == lim) return false;
+                b = cur; // last line without a trailing newline
+                e = lim;
+                cur = lim;
+                return true;
+            }
+        }
+    }
+
+    // Keep the unfinished line at the front of the buffer and read the next block after it
+    bool refill() {
+        if (!file) return false;
+        size_t offset = cur - buffer.data();
+        size_t keep = lim - cur;
+        if (keep == buffer.size()) buffer.resize(buffer.size() * 2); // a single line longer than a block
+        memmove(buffer.data(), buffer.data() + offset, keep);
+        size_t got = fread(buffer.data() + keep, 1, buffer.size() - keep, file);
+        cur = buffer.data();
+        lim = cur + keep + got;
+        if (got == 0) {
+            atEof = true;
+            return false;
+        }
+        return true;
+    }
+};
+
+// A percentile for the summary tables ("-" when nothing was recorded)
+string percentileText(int value) {
+    return value < 0 ? string("-") : to_string(value);
+}
+
+// Print the per-route statistics gathered by either engine
+void printSummary(const TaxiRank& rank, int maxTime) {
+    double hours = (double)(maxTime + 1) / rank.ticksPerHour;
+    cout << "\nSummary for time 0 to " << maxTime << ":\n";
+    cout << left << setw(8) << "Route" << setw(10) << "Boarded" << setw(12) << "Departures"
+         << setw(12) << "Wait ticks" << setw(12) << "Peak WaitQ" << setw(12) << "Taxis/hour";
+#if TAXI_METRICS
+    cout << setw(18) << "Wait p50/p95/p99" << setw(10) << "Fill p50";
+#endif
+    cout << "\n";
+    for (int r = 0; r < rank.routeCount(); ++r) {
+        const RouteStats& st = rank.stats[r];
+        ostringstream perHour;
+        perHour << fixed << setprecision(1) << st.departures / hours;
+        cout << left << setw(8) << rank.names[r] << setw(10) << st.boarded
+             << setw(12) << st.departures << setw(12) << st.waitTicks
+             << setw(12) << st.peakWait << setw(12) << perHour.str();
+#if TAXI_METRICS
+        string waits = percentileText(rank.waitHist.percentile(r, 0.50)) + "/" +
+                       percentileText(rank.waitHist.percentile(r, 0.95)) + "/" +
+                       percentileText(rank.waitHist.percentile(r, 0.99));
+        cout << setw(18) << waits << setw(10) << percentileText(rank.fillHist.percentile(r, 0.50));
+#endif
+        cout << "\n";
+    }
+}
+
+// -------------------------------- Output Sinks --------------------------------
+/*
+The simulation hands each time step to a sink and the sink decides what to
+write, so only the chosen output format does any formatting:
+- TableSink:   the human-readable table (the original output)
+- CsvSink:     one "time,route,arrivals,queue,wait_q,seats" line per route per step
+- BinarySink:  the same columns as raw int32 arrays, in blocks of rows
+- SummarySink: no rows at all, just the per-route summary at the end
+All of them collect their output in a large buffer and write it out in big
+chunks; nothing is flushed per row.
+*/
+
+// Buffered writer over stdout or a file
+class OutputBuffer {
+public:
+    explicit OutputBuffer(const string& path) {
+        if (path.empty() || path == "-") {
+            file = stdout;
+        } else {
+            file = fopen(path.c_str(), "wb");
+            owned = file != nullptr;
+            if (!file) cerr << "ERROR: Could not open output file: " << path << endl;
+        }
+        buf.reserve(CAPACITY);
+    }
+    ~OutputBuffer() {
+        flush();
+        if (owned) fclose(file);
+    }
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    bool ok() const { return file != nullptr; }
+    bool toStdout() const { return file == stdout; }
+
+    void write(const char* data, size_t len) {
+        buf.append(data, len);
+        if (buf.size() >= CAPACITY) flush();
+    }
+    void write(const string& text) { write(text.data(), text.size()); }
+    void write(char c) { buf.push_back(c); }
+
+    // Decimal number without going through streams or printf
+    void writeInt(long long v) {
+        char tmp[24];
+        int n = 0;
+        unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+        do { tmp[n++] = char('0' + u % 10); u /= 10; } while (u);
+        if (v < 0) tmp[n++] = '-';
+        while (n) buf.push_back(tmp[--n]);
+    }
+
+    // Text left-aligned in a column of 'width' characters (like setw with left)
+    void cell(const char* text, size_t len, size_t width) {
+        write(text, len);
+        if (len < width) buf.append(width - len, ' ');
+    }
+    void cell(const string& text, size_t width) { cell(text.data(), text.size(), width); }
+    void cell(long long v, size_t width) {
+        size_t before = buf.size();
+        writeInt(v);
+        size_t len = buf.size() - before;
+        if (len < width) buf.append(width - len, ' ');
+    }
+
+    void flush() {
+        if (file && !buf.empty()) fwrite(buf.data(), 1, buf.size(), file);
+        buf.clear();
+        if (file) fflush(file); // only at the end of a chunk, never per row
+    }
+
+private:
+    static const size_t CAPACITY = 1 << 20;
+    FILE* file = nullptr;
+    bool owned = false;
+    string buf;
+};
+
+class SimulationSink {
+public:
+    virtual ~SimulationSink() {}
+    // Sinks that do not show time steps say so, and the engine skips the per-row work
+    virtual bool wantsRows() const { return true; }
+    // One time step: the passengers that arrived in it and the WaitQ column per route
+    virtual void row(const TaxiRank& rank, int time, const vector<Passenger>& arrived, const vector<int>& waitNow) = 0;
+    virtual void finish(const TaxiRank& rank, int maxTime) = 0;
+};
+
+class TableSink : public SimulationSink {
+public:
+    explicit TableSink(const string& path) : out(path) {}
+
+    void row(const TaxiRank& rank, int time, const vector<Passenger>& arrived, const vector<int>& waitNow) override {
+        const int n = rank.routeCount();
+        if (n != headerRoutes) { // new routes showed up in the data: the columns change
+            header(rank);
+            headerRoutes = n;
+        }
+        arrivalText.clear();
+        for (const Passenger& p : arrived) {
+            arrivalText += rank.names[p.route];
+            arrivalText += '(';
+            arrivalText += to_string(p.boardingTime);
+            arrivalText += ") ";
+        }
+        out.cell(time, 6);
+        out.cell(arrivalText, 20);
+        for (int r = 0; r < n; ++r) out.cell(rank.inQueue[r], 6);
+        for (int r = 0; r < n; ++r) out.cell(waitNow[r], 12);
+        for (int r = 0; r < n; ++r) out.cell(rank.routeSeats(r), 10);
+        out.write('\n');
+    }
+
+    void finish(const TaxiRank& rank, int maxTime) override {
+        out.flush();
+        printSummary(rank, maxTime);
+    }
+
+private:
+    OutputBuffer out;
+    int headerRoutes = -1; // number of routes in the last printed header
+    string arrivalText;
+
+    void header(const TaxiRank& rank) {
+        const int n = rank.routeCount();
+        out.cell("Time", 4, 6);
+        out.cell("New Arrivals", 12, 20);
+        for (int r = 0; r < n; ++r) out.cell(rank.names[r], 6);
+        for (int r = 0; r < n; ++r) out.cell("WaitQ " + rank.names[r], 12);
+        for (int r = 0; r < n; ++r) out.cell("Cap " + rank.names[r], 10);
+        out.write('\n');
+        out.write(string(26 + 28 * n, '-')); // line separator
+        out.write('\n');
+    }
+};
+
+class CsvSink : public SimulationSink {
+public:
+    explicit CsvSink(const string& path) : out(path) {
+        out.write("time,route,arrivals,queue,wait_q,seats\n");
+    }
+
+    void row(const TaxiRank& rank, int time, const vector<Passenger>& arrived, const vector<int>& waitNow) override {
+        const int n = rank.routeCount();
+        arrivedPerRoute.assign(n, 0);
+        for (const Passenger& p : arrived) arrivedPerRoute[p.route]++;
+        for (int r = 0; r < n; ++r) {
+            out.writeInt(time);
+            out.write(',');
+            out.write(rank.names[r]);
+            out.write(',');
+            out.writeInt(arrivedPerRoute[r]);
+            out.write(',');
+            out.writeInt(rank.inQueue[r]);
+            out.write(',');
+            out.writeInt(waitNow[r]);
+            out.write(',');
+            out.writeInt(rank.routeSeats(r));
+            out.write('\n');
+        }
+    }
+
+    void finish(const TaxiRank& rank, int maxTime) override {
+        out.flush();
+        if (!out.toStdout()) printSummary(rank, maxTime); // keep stdout pure CSV
+    }
 
-    printHeader(); // Print the column headers
+private:
+    OutputBuffer out;
+    vector<int> arrivedPerRoute;
+};
 
-    for (int time = 0; time <= maxTime; ++time) {
-        // Get new arrivals for the current time (if any)
-        vector<Passenger> newArrivals = arrivals[time];
-        stringstream arrivalStr;
+/*
+Binary columnar file (native byte order, little-endian on x86):
+  "TAXICOL1"
+  blocks:  uint32 rows (> 0), then six int32 columns of 'rows' values each:
+           time, route id, arrivals, queue, wait_q, seats
+  trailer: uint32 0, uint32 routeCount, then per route uint32 length + name bytes
+*/
+class BinarySink : public SimulationSink {
+public:
+    explicit BinarySink(const string& path) : out(path) {
+        out.write("TAXICOL1", 8);
+    }
 
-        // Push each new passenger into the correct queue
-        for (Passenger& p : newArrivals) {
-            if (p.route == 'S') queueS.push(p);
-            else if (p.route == 'L') queueL.push(p);
-            else if (p.route == 'C') queueC.push(p);
+    void row(const TaxiRank& rank, int time, const vector<Passenger>& arrived, const vector<int>& waitNow) override {
+        const int n = rank.routeCount();
+        arrivedPerRoute.assign(n, 0);
+        for (const Passenger& p : arrived) arrivedPerRoute[p.route]++;
+        for (int r = 0; r < n; ++r) {
+            columns[0].push_back(time);
+            columns[1].push_back(r);
+            columns[2].push_back(arrivedPerRoute[r]);
+            columns[3].push_back(rank.inQueue[r]);
+            columns[4].push_back(waitNow[r]);
+            columns[5].push_back(rank.routeSeats(r));
+        }
+        if (columns[0].size() >= BLOCK_ROWS) writeBlock();
+    }
 
-            arrivalStr << p.route << "(" << p.boardingTime << ") ";
+    void finish(const TaxiRank& rank, int maxTime) override {
+        writeBlock();
+        writeU32(0);
+        writeU32((uint32_t)rank.routeCount());
+        for (const string& name : rank.names) {
+            writeU32((uint32_t)name.size());
+            out.write(name);
         }
+        out.flush();
+        if (!out.toStdout()) printSummary(rank, maxTime);
+    }
+
+private:
+    static const size_t BLOCK_ROWS = 1 << 16;
+    OutputBuffer out;
+    vector<int> arrivedPerRoute;
+    vector<int32_t> columns[6];
+
+    void writeU32(uint32_t v) { out.write((const char*)&v, sizeof(v)); }
+
+    void writeBlock() {
+        if (columns[0].empty()) return;
+        writeU32((uint32_t)columns[0].size());
+        for (vector<int32_t>& col : columns) {
+            out.write((const char*)col.data(), col.size() * sizeof(int32_t));
+            col.clear();
+        }
+    }
+};
+
+class SummarySink : public SimulationSink {
+public:
+    bool wantsRows() const override { return false; }
+    void row(const TaxiRank&, int, const vector<Passenger>&, const vector<int>&) override {}
+    void finish(const TaxiRank& rank, int maxTime) override { printSummary(rank, maxTime); }
+};
+
+// Function that simulates the taxi rank one time step at a time, from rank.now up to maxTime
+// Arrivals are pulled from the stream as the clock reaches them, so the whole day is never held in memory
+void simulateTaxiRank(TaxiRank& rank, ArrivalSource& arrivals, SimulationSink& sink, int maxTime = 25) {
+    Arrival next; // the next arrival in the file (read one ahead)
+    bool hasNext = arrivals.next(next);
+    vector<int> waitNow; // the WaitQ column for this time step
+    vector<Passenger> arrivedNow; // passengers that arrived in this time step (for the sink)
+    const bool wantsRows = sink.wantsRows();
+
+    for (int time = rank.now; time <= maxTime; ++time) {
+        rank.now = time;
+        arrivedNow.clear();
+
+        // Push each passenger arriving now into their route queue
+        while (hasNext && next.time == time) {
+            rank.enqueue(next.passenger);
+            if (wantsRows) arrivedNow.push_back(next.passenger);
+            hasNext = arrivals.next(next);
+        }
+
+        const int numRoutes = rank.routeCount();
+        const int numBays = rank.totalBays();
+
+        // Number of passengers that have to wait for someone in front of them
+        waitNow.resize(numRoutes);
+        for (int r = 0; r < numRoutes; ++r) {
+            int waitCount = max(rank.inQueue[r] - rank.bayCount[r], 0);
+            waitNow[r] = waitCount;
+            rank.stats[r].waitTicks += waitCount;
+            rank.stats[r].peakWait = max(rank.stats[r].peakWait, waitCount);
+        }
+
+        // One pass over every bay of every route
+        for (int b = 0; b < numBays; ++b) {
+            int r = rank.bayRoute[b];
 
-        // Lambda function to process a single taxi's behavior each time step
-        auto processTaxi = [](queue<Passenger>& q, Taxi& taxi) {
-            int waitCount = max((int)q.size() - 1, 0); // number of waiting passengers (not including current boarding)
-        
             // If someone is already boarding, reduce their boarding time
-            if (taxi.isBoarding) {
-                taxi.remainingBoardTime--;
-                if (taxi.remainingBoardTime == 0) {
-                    taxi.capacity--;  // one seat is taken
-                    q.pop(); // remove passenger from queue
-                    taxi.isBoarding = false;
+            if (rank.boardLeft[b] > 0 && --rank.boardLeft[b] == 0) {
+                rank.seats[b]--; // one seat is taken
+                rank.inQueue[r]--;
+                rank.stats[r].boarded++;
+                if (rank.seats[b] == 0) { // that was the last seat
+                    rank.stats[r].departures++;
+                    rank.recordDeparture(b);
+                }
+            }
+
+            // Start the next boarding if nobody is boarding at this bay
+            if (rank.boardLeft[b] == 0 && rank.waiting[r] > 0) {
+                Passenger p = rank.dequeue(r);
+                rank.recordBoardingStart(p);
+                rank.boardLeft[b] = p.boardingTime;
+            }
+
+            // If the taxi is full it "departs" (this tick stays at 0 seats),
+            // and the tick after that a new one arrives with all seats free
+            if (rank.seats[b] == 0 && !rank.justLeft[b]) {
+                rank.justLeft[b] = 1;
+            } else if (rank.justLeft[b]) {
+                rank.seats[b] = rank.taxiSize[b];
+                rank.justLeft[b] = 0;
+                rank.recordTaxiArrival(b);
+            }
+        }
+
+        // Hand the current time step to the output sink
+        if (wantsRows) sink.row(rank, time, arrivedNow, waitNow);
+    }
+    rank.now = max(rank.now, maxTime + 1);
+}
+
+// ------------------------- Event-driven simulation ---------------------------
+/*
+The per-tick loop above visits every time step even when nothing happens.
+The event-driven engine keeps a calendar (min-heap) of the moments where
+something changes and jumps straight from one to the next:
+- ARRIVAL:           a passenger joins a route queue (only the next row of the
+                     file is ever in the calendar, so memory stays small)
+- BOARDING_COMPLETE: the passenger at a bay has taken their seat
+- DISPATCH:          free bays of a route call the next waiting passengers
+- TAXI_DEPARTURE:    the last seat at a bay was taken, the taxi leaves
+- TAXI_ARRIVAL:      the next empty taxi pulls into the bay one step later
+Events at the same time are handled in that order, which matches the order
+of the per-tick loop, so both engines give identical RouteStats and leave the
+TaxiRank in the same state. While it runs, boardLeft holds the time the
+boarding finishes instead of a countdown; it is converted back at the end.
+The cost grows with the number of events instead of with maxTime.
+*/
+
+enum EventKind { ARRIVAL = 0, BOARDING_COMPLETE = 1, DISPATCH = 2, TAXI_DEPARTURE = 3, TAXI_ARRIVAL = 4 };
+
+struct Event {
+    int time;
+    EventKind kind;
+    int id; // route id for ARRIVAL and DISPATCH, bay id otherwise
+    bool operator>(const Event& other) const {
+        if (time != other.time) return time > other.time;
+        if (kind != other.kind) return kind > other.kind;
+        return id > other.id;
+    }
+};
+
+void simulateTaxiRankEvents(TaxiRank& rank, ArrivalSource& arrivals, int maxTime = 25) {
+    priority_queue<Event, vector<Event>, greater<Event>> calendar;
+    vector<int> accountedUntil;   // per route: time steps before this are already in waitTicks
+    vector<char> dispatchPending; // per route: is a DISPATCH already in the calendar?
+    int knownBays = 0;            // bays whose events are already in the calendar
+
+    // Routes can appear while reading the file, so the per-route helpers grow with the
+    // table and the calendar is filled in from the state of any new bays
+    auto trackRoutes = [&]() {
+        accountedUntil.resize(rank.routeCount(), rank.now);
+        dispatchPending.resize(rank.routeCount(), 0);
+        for (; knownBays < rank.totalBays(); ++knownBays) {
+            int b = knownBays;
+            if (rank.boardLeft[b] > 0) {
+                rank.boardLeft[b] += rank.now - 1; // countdown -> finishing time
+                calendar.push({rank.boardLeft[b], BOARDING_COMPLETE, b});
+            }
+            if (rank.justLeft[b]) calendar.push({rank.now, TAXI_ARRIVAL, b});
+            else if (rank.seats[b] == 0) calendar.push({rank.now, TAXI_DEPARTURE, b});
+        }
+    };
+
+    Arrival next; // the passenger behind the single ARRIVAL event in the calendar
+    auto scheduleNextArrival = [&]() {
+        if (arrivals.next(next) && next.time <= maxTime) {
+            trackRoutes();
+            calendar.push({next.time, ARRIVAL, next.passenger.route});
+        }
+    };
+
+    auto scheduleDispatch = [&](int r, int time) {
+        if (!dispatchPending[r]) {
+            dispatchPending[r] = 1;
+            calendar.push({time, DISPATCH, r});
+        }
+    };
+
+    // Add the WaitQ value for every time step in [accountedUntil, time) to the statistics.
+    // The queue length only changes at events, so each gap is one multiplication.
+    auto accrue = [&](int r, int time) {
+        if (time <= accountedUntil[r]) return;
+        int waitCount = max(rank.inQueue[r] - rank.bayCount[r], 0);
+        rank.stats[r].waitTicks += (long long)waitCount * (time - accountedUntil[r]);
+        rank.stats[r].peakWait = max(rank.stats[r].peakWait, waitCount);
+        accountedUntil[r] = time;
+    };
+
+    // Build the calendar from the current state of every bay
+    trackRoutes();
+    for (int r = 0; r < rank.routeCount(); ++r) {
+        if (rank.waiting[r] > 0) scheduleDispatch(r, rank.now);
+    }
+    scheduleNextArrival();
+
+    while (!calendar.empty() && calendar.top().time <= maxTime) {
+        Event ev = calendar.top();
+        calendar.pop();
+        rank.now = ev.time;
+
+        switch (ev.kind) {
+        case ARRIVAL: {
+            int r = ev.id;
+            accrue(r, ev.time); // time steps before this one used the old queue length
+            rank.enqueue(next.passenger);
+            scheduleDispatch(r, ev.time);
+            scheduleNextArrival();
+            break;
+        }
+        case BOARDING_COMPLETE: {
+            int b = ev.id, r = rank.bayRoute[b];
+            accrue(r, ev.time + 1); // this time step still counts the boarding passenger
+            rank.boardLeft[b] = 0;
+            rank.seats[b]--;
+            rank.inQueue[r]--;
+            rank.stats[r].boarded++;
+            if (rank.seats[b] == 0) {
+                rank.stats[r].departures++;
+                rank.recordDeparture(b);
+                calendar.push({ev.time, TAXI_DEPARTURE, b});
+            }
+            if (rank.waiting[r] > 0) scheduleDispatch(r, ev.time);
+            break;
+        }
+        case DISPATCH: {
+            int r = ev.id;
+            dispatchPending[r] = 0;
+            for (int b = rank.bayBegin[r]; b < rank.bayBegin[r] + rank.bayCount[r] && rank.waiting[r] > 0; ++b) {
+                if (rank.boardLeft[b] == 0) {
+                    Passenger p = rank.dequeue(r);
+                    rank.recordBoardingStart(p);
+                    rank.boardLeft[b] = ev.time + p.boardingTime;
+                    calendar.push({rank.boardLeft[b], BOARDING_COMPLETE, b});
                 }
             }
-        
-            // Start next boarding if not currently boarding
-            if (!taxi.isBoarding && !q.empty()) {
-                taxi.remainingBoardTime = q.front().boardingTime;
-                taxi.isBoarding = true;
-            }
-        
-            // If taxi is empty and hasn’t left yet, let it "depart"
-            if (taxi.capacity == 0 && !taxi.justLeft) {
-                taxi.justLeft = true; // mark departure
-                return waitCount;     // this tick stays at 0 capacity
-            }
-        
-            // If taxi just left, bring in a new one with full capacity
-            if (taxi.justLeft) {
-                taxi.capacity = 5;
-                taxi.justLeft = false;
-            }
-        
-            return waitCount;
-        };
-        
-        
-        // Process each taxi queue and get the number of people still waiting
-        int waitS = processTaxi(queueS, taxiS);
-        int waitL = processTaxi(queueL, taxiL);
-        int waitC = processTaxi(queueC, taxiC);
-
-        // Print all info for the current time step
-        cout << left << setw(6) << time
-             << setw(20) << arrivalStr.str()
-             << setw(6) << queueS.size()
-             << setw(6) << queueL.size()
-             << setw(6) << queueC.size()
-             << setw(12) << waitS
-             << setw(12) << waitL
-             << setw(12) << waitC
-             << setw(10) << taxiS.capacity
-             << setw(10) << taxiL.capacity
-             << setw(10) << taxiC.capacity
-             << endl;
+            break;
+        }
+        case TAXI_DEPARTURE:
+            rank.justLeft[ev.id] = 1;
+            calendar.push({ev.time + 1, TAXI_ARRIVAL, ev.id});
+            break;
+        case TAXI_ARRIVAL:
+            rank.seats[ev.id] = rank.taxiSize[ev.id];
+            rank.justLeft[ev.id] = 0;
+            rank.recordTaxiArrival(ev.id);
+            break;
+        }
     }
+
+    // Hand the state back in the per-tick form (finishing time -> countdown)
+    for (int r = 0; r < rank.routeCount(); ++r) accrue(r, maxTime + 1);
+    for (int b = 0; b < rank.totalBays(); ++b) {
+        if (rank.boardLeft[b] > 0) rank.boardLeft[b] -= maxTime;
+    }
+    rank.now = max(rank.now, maxTime + 1);
+}
+
+// ----------------------------- Queue Benchmark --------------------------------
+/*
+Compares the arena ring buffers in TaxiRank with one std::queue per route
+(backed by std::deque, which allocates and frees chunks as queues grow and
+shrink). Both replay the same arrival trace through a simple one-bay-per-route
+drain: every time step the new arrivals are queued, then each free bay takes
+the passenger at the front and is busy for their boarding time. After every
+round the queues are drained, so later rounds show the steady state.
+*/
+
+struct StdQueues {
+    vector<queue<Passenger>> q;
+    explicit StdQueues(int numRoutes) : q(numRoutes) {}
+    void push(const Passenger& p) { q[p.route].push(p); }
+    Passenger pop(int r) { Passenger p = q[r].front(); q[r].pop(); return p; }
+    bool empty(int r) const { return q[r].empty(); }
+};
+
+struct ArenaQueues {
+    TaxiRank& rank;
+    explicit ArenaQueues(TaxiRank& owner) : rank(owner) {}
+    void push(const Passenger& p) { rank.enqueue(p); }
+    Passenger pop(int r) { return rank.dequeue(r); }
+    bool empty(int r) const { return rank.waiting[r] == 0; }
+};
+
+// Replay the trace once through the queues; returns a checksum so both versions can be compared
+template <class Queues>
+long long replayTrace(Queues& queues, const vector<Arrival>& trace, int numRoutes, vector<int>& busyUntil) {
+    long long checksum = 0;
+    size_t i = 0;
+    int queued = 0;
+    busyUntil.assign(numRoutes, 0);
+    for (int time = 0; i < trace.size() || queued > 0; ++time) {
+        for (; i < trace.size() && trace[i].time == time; ++i) {
+            queues.push(trace[i].passenger);
+            queued++;
+        }
+        for (int r = 0; r < numRoutes; ++r) {
+            if (busyUntil[r] <= time && !queues.empty(r)) {
+                Passenger p = queues.pop(r);
+                busyUntil[r] = time + p.boardingTime;
+                checksum = checksum * 31 + p.boardingTime;
+                queued--;
+            }
+        }
+    }
+    return checksum;
+}
+
+// Time 'rounds' replays of the trace; returns milliseconds
+template <class Queues>
+double timeReplays(Queues& queues, const vector<Arrival>& trace, int numRoutes, int rounds, long long& checksum) {
+    vector<int> busyUntil;
+    auto start = chrono::steady_clock::now();
+    for (int k = 0; k < rounds; ++k) checksum += replayTrace(queues, trace, numRoutes, busyUntil);
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void benchmarkQueues(TaxiRank& rank, ArrivalStream& arrivals) {
+    vector<Arrival> trace; // the benchmark needs the whole trace up front so both versions see the same one
+    Arrival a;
+    while (arrivals.next(a)) trace.push_back(a);
+    if (trace.empty()) {
+        cerr << "ERROR: no arrivals to benchmark with" << endl;
+        return;
+    }
+    const int numRoutes = rank.routeCount();
+    const int rounds = (int)max<size_t>(1, 2000000 / trace.size()); // about two million passengers per run
+    const double passengers = (double)trace.size() * rounds;
+
+    long long stdSum = 0, arenaSum = 0;
+    StdQueues stdQueues(numRoutes);
+    ArenaQueues arenaQueues(rank);
+    timeReplays(stdQueues, trace, numRoutes, 1, stdSum); // warm-up round for both
+    timeReplays(arenaQueues, trace, numRoutes, 1, arenaSum);
+    long long growthsBefore = rank.ringGrowths;
+
+    double stdMs = timeReplays(stdQueues, trace, numRoutes, rounds, stdSum);
+    double arenaMs = timeReplays(arenaQueues, trace, numRoutes, rounds, arenaSum);
+
+    cout << "Queue benchmark: " << trace.size() << " arrivals on " << numRoutes << " routes, "
+         << rounds << " rounds after one warm-up round\n";
+    cout << left << setw(14) << "Queue" << setw(14) << "Time (ms)" << setw(18) << "ns per passenger" << "\n";
+    cout << left << setw(14) << "std::queue" << setw(14) << fixed << setprecision(2) << stdMs
+         << setw(18) << stdMs * 1e6 / passengers << "\n";
+    cout << left << setw(14) << "ring arena" << setw(14) << arenaMs
+         << setw(18) << arenaMs * 1e6 / passengers << "\n";
+    cout << "Ring moves after warm-up: " << rank.ringGrowths - growthsBefore << "\n";
+    if (stdSum != arenaSum) cout << "WARNING: the two queues did not produce the same boarding order\n";
+}
+
+// ------------------------------ Monte Carlo Runs ------------------------------
+/*
+For capacity planning we run many randomized days instead of one recorded one:
+- SyntheticArrivals generates a Poisson arrival stream for every route (each
+  route has its own rate) and draws boarding times from a BoardingTimeDist.
+- Every scenario gets its own random generator seeded from (seed, scenario
+  number), so a scenario produces the same day whichever thread runs it and
+  the merged results only depend on the seed, never on the thread count.
+- Scenarios run on a small work-stealing pool: each worker starts with its
+  own slice of scenarios and steals from the others once its slice is done.
+- Every worker adds its results into its own totals; the totals are merged
+  at the end (sums and maxima, so the merge order does not matter).
+*/
+
+// Distribution of boarding times: "uniform:A:B", "fixed:K" or "exp:MEAN"
+struct BoardingTimeDist {
+    enum Kind { UNIFORM, FIXED, EXPONENTIAL } kind = UNIFORM;
+    int low = 1, high = 6; // UNIFORM range, or low = K for FIXED
+    double mean = 3.0;     // EXPONENTIAL mean (rounded up, at least 1)
+
+    static bool parse(const string& spec, BoardingTimeDist& out) {
+        BoardingTimeDist d;
+        if (sscanf(spec.c_str(), "uniform:%d:%d", &d.low, &d.high) == 2 && d.low >= 1 && d.high >= d.low) {
+            d.kind = UNIFORM;
+        } else if (sscanf(spec.c_str(), "fixed:%d", &d.low) == 1 && d.low >= 1) {
+            d.kind = FIXED;
+            d.high = d.low;
+        } else if (sscanf(spec.c_str(), "exp:%lf", &d.mean) == 1 && d.mean > 0) {
+            d.kind = EXPONENTIAL;
+        } else {
+            return false;
+        }
+        out = d;
+        return true;
+    }
+
+    int sample(mt19937_64& rng) const {
+        switch (kind) {
+        case FIXED: return low;
+        case EXPONENTIAL: return max(1, (int)ceil(exponential_distribution<double>(1.0 / mean)(rng)));
+        default: return uniform_int_distribution<int>(low, high)(rng);
+        }
+    }
+};
+
+// Mix a seed and a scenario number into a well-spread 64-bit seed (splitmix64)
+uint64_t scenarioSeed(uint64_t seed, uint64_t scenario) {
+    uint64_t z = seed + (scenario + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Poisson arrivals for all routes at once: the gaps between arrivals of the
+// combined stream are exponential with the total rate, and each arrival picks
+// its route in proportion to the route's rate.
+class SyntheticArrivals : public ArrivalSource {
+public:
+    SyntheticArrivals(const vector<double>& rates, const BoardingTimeDist& boardingTimes, int lastTime, uint64_t seed)
+        : boarding(boardingTimes), maxTime(lastTime), rng(seed) {
+        double total = 0;
+        for (double r : rates) cumulative.push_back(total += r);
+    }
+
+    bool next(Arrival& out) override {
+        if (cumulative.empty() || cumulative.back() <= 0) return false;
+        clock += exponential_distribution<double>(cumulative.back())(rng);
+        if (clock >= maxTime + 1.0) return false;
+        double pick = uniform_real_distribution<double>(0, cumulative.back())(rng);
+        int route = (int)(upper_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin());
+        out.time = (int)clock;
+        out.passenger.route = min(route, (int)cumulative.size() - 1);
+        out.passenger.boardingTime = boarding.sample(rng);
+        out.passenger.arrivalTime = out.time;
+        return true;
+    }
+
+private:
+    vector<double> cumulative; // running total of the route rates
+    BoardingTimeDist boarding;
+    int maxTime;
+    mt19937_64 rng;
+    double clock = 0; // continuous time of the last arrival
+};
+
+// Runs tasks 0..numTasks-1 on numThreads threads with work stealing.
+// task(taskId, workerId) must only touch data owned by that worker.
+template <class Task>
+void runWorkStealing(int numTasks, int numThreads, Task task) {
+    struct WorkerQueue {
+        mutex lock;
+        deque<int> tasks;
+    };
+    vector<WorkerQueue> queues(numThreads);
+    for (int t = 0; t < numTasks; ++t) {
+        queues[(long long)t * numThreads / numTasks].tasks.push_back(t); // contiguous slices
+    }
+
+    auto worker = [&](int id) {
+        while (true) {
+            int taskId = -1;
+            { // own work first, oldest task first
+                lock_guard<mutex> guard(queues[id].lock);
+                if (!queues[id].tasks.empty()) {
+                    taskId = queues[id].tasks.front();
+                    queues[id].tasks.pop_front();
+                }
+            }
+            // otherwise steal the newest task of another worker
+            for (int k = 1; taskId < 0 && k < numThreads; ++k) {
+                WorkerQueue& victim = queues[(id + k) % numThreads];
+                lock_guard<mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    taskId = victim.tasks.back();
+                    victim.tasks.pop_back();
+                }
+            }
+            if (taskId < 0) return; // nothing left anywhere (tasks never create new tasks)
+            task(taskId, id);
+        }
+    };
+
+    vector<thread> threads;
+    for (int id = 1; id < numThreads; ++id) threads.emplace_back(worker, id);
+    worker(0);
+    for (thread& t : threads) t.join();
+}
+
+// Results of many scenarios added together
+struct ScenarioTotals {
+    vector<RouteStats> stats;
+#if TAXI_METRICS
+    RouteHistograms waitHist;
+    RouteHistograms fillHist;
+#endif
+
+    void add(const TaxiRank& rank) {
+        stats.resize(max((int)stats.size(), rank.routeCount()));
+        for (int r = 0; r < rank.routeCount(); ++r) {
+            stats[r].boarded += rank.stats[r].boarded;
+            stats[r].departures += rank.stats[r].departures;
+            stats[r].waitTicks += rank.stats[r].waitTicks;
+            stats[r].peakWait = max(stats[r].peakWait, rank.stats[r].peakWait);
+        }
+#if TAXI_METRICS
+        waitHist.merge(rank.waitHist);
+        fillHist.merge(rank.fillHist);
+#endif
+    }
+
+    void merge(const ScenarioTotals& other) {
+        stats.resize(max(stats.size(), other.stats.size()));
+        for (size_t r = 0; r < other.stats.size(); ++r) {
+            stats[r].boarded += other.stats[r].boarded;
+            stats[r].departures += other.stats[r].departures;
+            stats[r].waitTicks += other.stats[r].waitTicks;
+            stats[r].peakWait = max(stats[r].peakWait, other.stats[r].peakWait);
+        }
+#if TAXI_METRICS
+        waitHist.merge(other.waitHist);
+        fillHist.merge(other.fillHist);
+#endif
+    }
+};
+
+// Run 'scenarios' random days on the rank's route table and print the merged results
+void runMonteCarlo(const TaxiRank& setup, const BoardingTimeDist& boarding, int maxTime,
+                   int scenarios, int numThreads, uint64_t seed) {
+    numThreads = max(1, min(numThreads, scenarios));
+    vector<ScenarioTotals> perWorker(numThreads);
+
+    auto start = chrono::steady_clock::now();
+    runWorkStealing(scenarios, numThreads, [&](int scenario, int worker) {
+        TaxiRank rank = setup; // fresh copy of the route table and fleets
+        SyntheticArrivals arrivals(rank.arrivalRate, boarding, maxTime, scenarioSeed(seed, scenario));
+        simulateTaxiRankEvents(rank, arrivals, maxTime);
+        perWorker[worker].add(rank);
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ScenarioTotals totals;
+    for (const ScenarioTotals& t : perWorker) totals.merge(t);
+    totals.stats.resize(setup.routeCount());
+    double hours = (double)scenarios * (maxTime + 1) / setup.ticksPerHour;
+
+    cout << "Monte Carlo: " << scenarios << " scenarios of time 0 to " << maxTime << ", seed " << seed
+         << ", " << numThreads << " threads, " << fixed << setprecision(2) << seconds << " s\n\n";
+    cout << left << setw(8) << "Route" << setw(6) << "Bays" << setw(6) << "Taxi" << setw(8) << "Rate"
+         << setw(14) << "Avg boarded" << setw(12) << "Taxis/hour" << setw(12) << "Avg WaitQ"
+         << setw(12) << "Peak WaitQ";
+#if TAXI_METRICS
+    cout << setw(18) << "Wait p50/p95/p99" << setw(10) << "Fill p50";
+#endif
+    cout << "\n";
+    for (int r = 0; r < setup.routeCount(); ++r) {
+        const RouteStats& st = totals.stats[r];
+        cout << left << setw(8) << setup.names[r] << setw(6) << setup.bayCount[r]
+             << setw(6) << setup.taxiSize[setup.bayBegin[r]] << setw(8) << setup.arrivalRate[r]
+             << setw(14) << (double)st.boarded / scenarios << setw(12) << st.departures / hours
+             << setw(12) << (double)st.waitTicks / ((double)scenarios * (maxTime + 1))
+             << setw(12) << st.peakWait;
+#if TAXI_METRICS
+        if (r < totals.waitHist.routeCount()) {
+            string waits = percentileText(totals.waitHist.percentile(r, 0.50)) + "/" +
+                           percentileText(totals.waitHist.percentile(r, 0.95)) + "/" +
+                           percentileText(totals.waitHist.percentile(r, 0.99));
+            cout << setw(18) << waits << setw(10) << percentileText(totals.fillHist.percentile(r, 0.50));
+        }
+#endif
+        cout << "\n";
+    }
+
+#if TAXI_METRICS
+    RouteHistograms all = totals.waitHist.combined();
+    cout << "\nTime steps from arriving to starting to board, all routes (" << all.total(0) << " passengers):\n";
+    cout << "  p50 " << percentileText(all.percentile(0, 0.50)) << ", p90 " << percentileText(all.percentile(0, 0.90))
+         << ", p95 " << percentileText(all.percentile(0, 0.95)) << ", p99 " << percentileText(all.percentile(0, 0.99))
+         << ", p99.9 " << percentileText(all.percentile(0, 0.999)) << ", max " << percentileText(all.percentile(0, 1.0)) << "\n";
+#endif
+    cout << left;
+}
+
+// Read "name,bays,taxi_size[,rate]" lines that set up the route table before the simulation.
+// Routes that only appear in the data file get the default fleet. The optional rate is the
+// expected number of arrivals per time step, used by synthetic (Monte Carlo) scenarios.
+bool loadRouteConfig(const string& path, TaxiRank& rank) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) {
+        cerr << "ERROR: Could not open route file at path: " << path << endl;
+        return false;
+    }
+    char line[512];
+    int lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        char name[256];
+        int bays, size;
+        double rate = rank.defaultRate;
+        int fields = sscanf(line, " %255[^,\r\n] , %d , %d , %lf", name, &bays, &size, &rate);
+        if (fields < 3 || bays < 1 || size < 1 || rate < 0) {
+            if (strspn(line, " \t\r\n") != strlen(line)) {
+                cerr << "WARNING: " << path << ":" << lineNo << ": expected name,bays,taxi_size[,rate], skipping" << endl;
+            }
+            continue;
+        }
+        string routeName = name;
+        while (!routeName.empty() && isspace((unsigned char)routeName.back())) routeName.pop_back();
+        int r = rank.addRoute(routeName, bays, size);
+        rank.arrivalRate[r] = rate;
+    }
+    fclose(f);
+    return true;
 }
 
 // Main function - starting point of the program
-int main() {
+// Usage: runTaxi [dataFile] [--events] [--max-time N] [--routes FILE] [--bays N] [--taxi-size N]
+//   --events        use the event-driven engine (skips quiet time steps, so it only prints the summary)
+//   --output KIND   table (default), csv, binary or summary
+//   --out FILE      write the table/csv/binary output to FILE instead of the screen
+//   --max-time N    simulate time steps 0..N (default 25)
+//   --routes FILE   route table with "name,bays,taxi_size" per line (default: S, L and C)
+//   --bays N        bays for routes not in the route file (default 1)
+//   --taxi-size N   seats per taxi for routes not in the route file (default 5)
+//   --ticks-per-hour N  time steps per hour for the "Taxis/hour" column (default 60)
+//   --resume FILE   continue from a snapshot (its route table replaces --routes); the data file
+//                   then only needs the arrivals from the snapshot's time onwards
+//   --save FILE     write a snapshot of the whole rank after the run, e.g. to continue with
+//                   the next batch of arrivals later: runTaxi batch2.txt --resume s --save s --max-time 2000
+//   --bench-queues  time the route queues against std::queue on the data file's arrivals
+//   --monte-carlo N run N random scenarios instead of the data file (see runMonteCarlo), with
+//     --seed S        seed for the scenarios (default 1)
+//     --threads N     worker threads (default: all cores)
+//     --rate X        arrivals per time step for routes without a rate in the route file (default 0.3)
+//     --boarding D    boarding times: uniform:A:B (default uniform:1:6), fixed:K or exp:MEAN
+int main(int argc, char* argv[]) {
     string filePath = "C:\\data\\taxiData.txt"; // path to the data file
-    map<int, vector<Passenger>> arrivals = readPassengerData(filePath); // load all passengers from file
+    string routesPath;
+    string resumePath, savePath;
+    int maxTime = 25;
+    bool eventDriven = false;
+    bool benchQueues = false;
+    string outputKind = "table";
+    string outputPath;
+    int scenarios = 0;
+    uint64_t seed = 1;
+    int numThreads = (int)thread::hardware_concurrency();
+    BoardingTimeDist boarding;
+    TaxiRank rank;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--events") eventDriven = true;
+        else if (arg == "--bench-queues") benchQueues = true;
+        else if (arg == "--output" && i + 1 < argc) outputKind = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) outputPath = argv[++i];
+        else if (arg == "--max-time" && i + 1 < argc) maxTime = atoi(argv[++i]);
+        else if (arg == "--routes" && i + 1 < argc) routesPath = argv[++i];
+        else if (arg == "--resume" && i + 1 < argc) resumePath = argv[++i];
+        else if (arg == "--save" && i + 1 < argc) savePath = argv[++i];
+        else if (arg == "--bays" && i + 1 < argc) rank.defaultBays = max(1, atoi(argv[++i]));
+        else if (arg == "--taxi-size" && i + 1 < argc) rank.defaultTaxiSize = max(1, atoi(argv[++i]));
+        else if (arg == "--ticks-per-hour" && i + 1 < argc) rank.ticksPerHour = max(1, atoi(argv[++i]));
+        else if (arg == "--monte-carlo" && i + 1 < argc) scenarios = max(1, atoi(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc) numThreads = max(1, atoi(argv[++i]));
+        else if (arg == "--rate" && i + 1 < argc) rank.defaultRate = max(0.0, atof(argv[++i]));
+        else if (arg == "--boarding" && i + 1 < argc) {
+            if (!BoardingTimeDist::parse(argv[++i], boarding)) {
+                cerr << "ERROR: unknown boarding time distribution: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else filePath = arg;
+    }
+
+    if (!resumePath.empty()) {
+        if (!loadSnapshot(rank, resumePath)) return 1;
+        if (rank.now > maxTime) {
+            cerr << "ERROR: the snapshot is already at time " << rank.now << ", past --max-time " << maxTime << endl;
+            return 1;
+        }
+    } else if (!routesPath.empty()) {
+        if (!loadRouteConfig(routesPath, rank)) return 1;
+    } else {
+        // The classic rank: Short-distance, Long-distance and City routes
+        rank.addRoute("S", rank.defaultBays, rank.defaultTaxiSize);
+        rank.addRoute("L", rank.defaultBays, rank.defaultTaxiSize);
+        rank.addRoute("C", rank.defaultBays, rank.defaultTaxiSize);
+    }
 
-    simulateTaxiRank(arrivals); // start the simulation
+    if (scenarios > 0) {
+        runMonteCarlo(rank, boarding, maxTime, scenarios, max(1, numThreads), seed);
+        return 0;
+    }
+
+    ArrivalStream arrivals(filePath, rank); // passengers are read from the file as the simulation needs them
+
+    if (benchQueues) {
+        benchmarkQueues(rank, arrivals);
+        return 0;
+    }
+
+    if (eventDriven) outputKind = "summary";
+    unique_ptr<SimulationSink> sink;
+    if (outputKind == "table") sink.reset(new TableSink(outputPath));
+    else if (outputKind == "csv") sink.reset(new CsvSink(outputPath));
+    else if (outputKind == "binary") sink.reset(new BinarySink(outputPath));
+    else if (outputKind == "summary") sink.reset(new SummarySink());
+    else {
+        cerr << "ERROR: unknown output kind: " << outputKind << endl;
+        return 1;
+    }
+
+    if (eventDriven) simulateTaxiRankEvents(rank, arrivals, maxTime);
+    else simulateTaxiRank(rank, arrivals, *sink, maxTime); // start the simulation
+
+    sink->finish(rank, maxTime);
+    if (!savePath.empty() && !saveSnapshot(rank, savePath)) return 1;
     return 0;
-}
\ No newline at end of file
+}
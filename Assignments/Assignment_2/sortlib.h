@@ -0,0 +1,1124 @@
+// sortlib.h
+// Header-only sorting library used by the Assignment 2 benchmarks.
+//
+// Every sort takes a random-access iterator range and either a comparator (a, b) -> bool or a
+// key function x -> key (a lambda or a member pointer such as &Event::time). Elements are only
+// ever moved, never copied, so move-only types can be sorted, and comparisons go through const
+// references, so sorting a large record by its key never copies the payload. All sorts are
+// stable (equal elements keep their order).
+//
+//   sorts::mergeSort(v.begin(), v.end());                            // operator<
+//   sorts::mergeSort(v.begin(), v.end(), greater<>());               // comparator
+//   sorts::mergeSort(events.begin(), events.end(), &Event::time);    // key
+//   sorts::adaptiveSort(log.begin(), log.end(), &Event::time);       // nearly sorted input
+//   sorts::radixSort<11>(events.begin(), events.end(), &Event::id);  // unsigned 32-bit key
+//   sorts::externalSort<Event>("events.bin", "sorted.bin", &Event::time, options); // bigger than RAM
+//
+// Needs C++17 (std::invoke, if constexpr, <filesystem>): compile with -std=c++17, since GCC 10
+// still defaults to gnu++14, and with -pthread for the parallel sorts.
+
+#ifndef SORTLIB_H
+#define SORTLIB_H
+
+#if __cplusplus < 201703L
+#error "sortlib.h needs C++17: compile with -std=c++17"
+#endif
+
+#include <algorithm> // for min, max, move
+#include <atomic> // for counting unfinished tasks
+#include <cerrno> // for errno in external sort I/O errors
+#include <chrono> // for the external sort timings
+#include <cstddef> // for ptrdiff_t, size_t
+#include <cstdint> // for uint32_t radix keys
+#include <cstdio> // for the external sort files
+#include <cstring> // for strerror
+#include <deque> // for the task pool deques
+#include <filesystem> // for the external sort's temporary run files
+#include <functional> // for invoke, less and tasks stored in the pool
+#include <iterator> // for iterator_traits, make_move_iterator
+#include <memory> // for the external sort's run readers
+#include <mutex> // for the task pool deques
+#include <stdexcept> // for external sort I/O errors
+#include <string> // for file paths
+#include <thread> // for the task pool workers
+#include <type_traits> // for telling comparators from key functions
+#include <utility> // for move, swap
+#include <vector> // for the scratch buffers
+
+namespace sorts {
+
+// ------------------------------- Comparators -------------------------------
+
+// Compares two elements by the key a key function extracts from them
+template <class Key>
+struct KeyLess {
+    Key key;
+    template <class A, class B>
+    bool operator()(const A& a, const B& b) const { return std::invoke(key, a) < std::invoke(key, b); }
+};
+
+template <class Key>
+KeyLess<Key> byKey(Key key) { return KeyLess<Key>{ key }; }
+
+// Orders ints as unsigned radix keys (flipping the sign bit puts negative values first)
+struct SignedIntKey {
+    uint32_t operator()(int value) const { return (uint32_t)value ^ 0x80000000u; }
+};
+
+namespace detail {
+
+// A callable that takes two elements is used as the comparator, one that takes a single
+// element is treated as a key function
+template <class T, class F>
+auto asComparator(F f) {
+    if constexpr (std::is_invocable_v<F&, const T&, const T&>) return f;
+    else return byKey(f);
+}
+
+template <class It>
+using ValueType = typename std::iterator_traits<It>::value_type;
+
+// Runs shorter than this are insertion sorted
+constexpr ptrdiff_t INSERTION_SORT_CUTOFF = 24;
+// Below these sizes the parallel sorts do the work sequentially
+constexpr ptrdiff_t PARALLEL_SORT_CUTOFF = 1 << 14;
+constexpr ptrdiff_t PARALLEL_MERGE_CHUNK = 1 << 15;
+constexpr size_t PARALLEL_RADIX_CUTOFF = 1 << 16;
+
+} // namespace detail
+
+// ---------------------------- Simple Sorts ----------------------------
+
+template <class RandomIt, class F>
+void insertionSort(RandomIt first, RandomIt last, F compareOrKey) {
+    auto comp = detail::asComparator<detail::ValueType<RandomIt>>(compareOrKey);
+    if (last - first < 2) return;
+    for (RandomIt i = first + 1; i != last; ++i) {
+        if (!comp(*i, *(i - 1))) continue;
+        auto value = std::move(*i);
+        RandomIt j = i;
+        do {
+            *j = std::move(*(j - 1));
+            --j;
+        } while (j != first && comp(value, *(j - 1)));
+        *j = std::move(value);
+    }
+}
+
+template <class RandomIt>
+void insertionSort(RandomIt first, RandomIt last) { insertionSort(first, last, std::less<>()); }
+
+template <class RandomIt, class F>
+void bubbleSort(RandomIt first, RandomIt last, F compareOrKey) {
+    auto comp = detail::asComparator<detail::ValueType<RandomIt>>(compareOrKey);
+    ptrdiff_t n = last - first;
+    for (ptrdiff_t i = 0; i < n - 1; ++i) {
+        bool swapped = false;
+        for (ptrdiff_t j = 0; j < n - i - 1; ++j) {
+            if (comp(first[j + 1], first[j])) {
+                std::iter_swap(first + j, first + j + 1);
+                swapped = true;
+            }
+        }
+        if (!swapped) break; // a pass without swaps means the range is sorted
+    }
+}
+
+template <class RandomIt>
+void bubbleSort(RandomIt first, RandomIt last) { bubbleSort(first, last, std::less<>()); }
+
+// ------------------------------ Merge Sort ------------------------------
+
+namespace detail {
+
+// Stable merge of two sorted runs into out (ties take the run a)
+template <class InA, class InB, class Out, class Compare>
+Out moveMerge(InA a, InA aEnd, InB b, InB bEnd, Out out, Compare& comp) {
+    while (a != aEnd && b != bEnd) {
+        if (comp(*b, *a)) *out++ = std::move(*b++);
+        else *out++ = std::move(*a++);
+    }
+    out = std::move(a, aEnd, out);
+    return std::move(b, bEnd, out);
+}
+
+// Merges the sorted halves src[0..mid) and src[mid..n) into dst (a move when already in order)
+template <class Src, class Dst, class Compare>
+void mergeHalves(Src src, ptrdiff_t mid, ptrdiff_t n, Dst dst, Compare& comp) {
+    if (!comp(src[mid], src[mid - 1])) std::move(src, src + n, dst);
+    else moveMerge(src, src + mid, src + mid, src + n, dst, comp);
+}
+
+// Sorts the n elements held in a, leaving the result in b when resultInB (otherwise in a).
+// The halves are sorted into the opposite array and merged across, so the data ping-pongs
+// between the two arrays and nothing is allocated during the sort.
+template <class ItA, class ItB, class Compare>
+void sortInto(ItA a, ItB b, ptrdiff_t n, bool resultInB, Compare& comp) {
+    if (n <= INSERTION_SORT_CUTOFF) {
+        insertionSort(a, a + n, comp);
+        if (resultInB) std::move(a, a + n, b);
+        return;
+    }
+    ptrdiff_t mid = n / 2;
+    sortInto(a, b, mid, !resultInB, comp);
+    sortInto(a + mid, b + mid, n - mid, !resultInB, comp);
+    if (resultInB) mergeHalves(a, mid, n, b, comp);
+    else mergeHalves(b, mid, n, a, comp);
+}
+
+} // namespace detail
+
+// Merge sort with one scratch buffer for the whole sort (elements are moved into it)
+template <class RandomIt, class F>
+void mergeSort(RandomIt first, RandomIt last, F compareOrKey) {
+    auto comp = detail::asComparator<detail::ValueType<RandomIt>>(compareOrKey);
+    ptrdiff_t n = last - first;
+    if (n <= detail::INSERTION_SORT_CUTOFF) {
+        insertionSort(first, last, comp);
+        return;
+    }
+    std::vector<detail::ValueType<RandomIt>> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    detail::sortInto(buffer.begin(), first, n, true, comp);
+}
+
+template <class RandomIt>
+void mergeSort(RandomIt first, RandomIt last) { mergeSort(first, last, std::less<>()); }
+
+// ------------------------------ Adaptive Sort ------------------------------
+
+namespace detail {
+
+// Natural merge sort in the style of TimSort: the input is cut into its existing ascending or
+// strictly descending runs (descending runs are reversed, which keeps the sort stable); short
+// runs are extended to a minimum length with binary insertion sort, and runs are merged off a
+// stack whose lengths are kept roughly Fibonacci-balanced. Merges trim the parts of both runs
+// that are already in place and switch to galloping (exponential search) while one run keeps
+// winning, so an already sorted input costs n - 1 comparisons and no moves.
+template <class RandomIt, class Compare>
+class AdaptiveSorter {
+public:
+    AdaptiveSorter(RandomIt first, Compare& compare) : a(first), comp(compare) {}
+
+    void sort(ptrdiff_t n) {
+        if (n < 2) return;
+        if (n < MIN_MERGE) {
+            binaryInsertionSort(0, n, countRunAndMakeAscending(0, n));
+            return;
+        }
+        ptrdiff_t minRun = minRunLength(n);
+        ptrdiff_t lo = 0, remaining = n;
+        while (remaining > 0) {
+            ptrdiff_t runLength = countRunAndMakeAscending(lo, lo + remaining);
+            if (runLength < minRun) {
+                ptrdiff_t forced = std::min(remaining, minRun);
+                binaryInsertionSort(lo, lo + forced, lo + runLength);
+                runLength = forced;
+            }
+            runs.push_back({ lo, runLength });
+            mergeCollapse();
+            lo += runLength;
+            remaining -= runLength;
+        }
+        while (runs.size() > 1) {
+            size_t i = runs.size() - 2;
+            if (i > 0 && runs[i - 1].length < runs[i + 1].length) --i;
+            mergeAt(i);
+        }
+    }
+
+private:
+    typedef ValueType<RandomIt> T;
+    typedef typename std::vector<T>::iterator TmpIt;
+
+    static constexpr ptrdiff_t MIN_MERGE = 64;
+    static constexpr int MIN_GALLOP = 7;
+
+    struct Run {
+        ptrdiff_t base;
+        ptrdiff_t length;
+    };
+
+    RandomIt a;
+    Compare& comp;
+    std::vector<T> tmp;        // holds the shorter run while merging
+    std::vector<Run> runs;     // pending runs, oldest first
+    int minGallop = MIN_GALLOP; // adapts: lower when galloping pays off
+
+    // n below 64 is used as is; otherwise a length in [32, 64] that splits n into a power of
+    // two (or slightly fewer) runs, which keeps the final merges balanced
+    static ptrdiff_t minRunLength(ptrdiff_t n) {
+        ptrdiff_t r = 0;
+        while (n >= MIN_MERGE) {
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    // Length of the run starting at lo, reversed in place if strictly descending
+    ptrdiff_t countRunAndMakeAscending(ptrdiff_t lo, ptrdiff_t hi) {
+        ptrdiff_t runHi = lo + 1;
+        if (runHi == hi) return 1;
+        if (comp(a[runHi++], a[lo])) {
+            while (runHi < hi && comp(a[runHi], a[runHi - 1])) ++runHi;
+            std::reverse(a + lo, a + runHi);
+        } else {
+            while (runHi < hi && !comp(a[runHi], a[runHi - 1])) ++runHi;
+        }
+        return runHi - lo;
+    }
+
+    // Sorts [lo, hi) given that [lo, start) is already sorted
+    void binaryInsertionSort(ptrdiff_t lo, ptrdiff_t hi, ptrdiff_t start) {
+        for (; start < hi; ++start) {
+            T pivot = std::move(a[start]);
+            ptrdiff_t left = lo, right = start;
+            while (left < right) {
+                ptrdiff_t mid = left + (right - left) / 2;
+                if (comp(pivot, a[mid])) right = mid;
+                else left = mid + 1;
+            }
+            std::move_backward(a + left, a + start, a + start + 1);
+            a[left] = std::move(pivot);
+        }
+    }
+
+    // Merges while the top three runs break X > Y + Z and Y > Z (checking one level deeper as
+    // well, which the original TimSort rule missed)
+    void mergeCollapse() {
+        while (runs.size() > 1) {
+            size_t n = runs.size() - 2;
+            if ((n > 0 && runs[n - 1].length <= runs[n].length + runs[n + 1].length) ||
+                (n > 1 && runs[n - 2].length <= runs[n - 1].length + runs[n].length)) {
+                if (runs[n - 1].length < runs[n + 1].length) --n;
+            } else if (runs[n].length > runs[n + 1].length) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+    // Index of the first element of s[base..base+length) not less than key, searching
+    // outwards from base + hint
+    template <class It>
+    ptrdiff_t gallopLeft(const T& key, It s, ptrdiff_t base, ptrdiff_t length, ptrdiff_t hint) {
+        ptrdiff_t lastOffset = 0, offset = 1;
+        if (comp(s[base + hint], key)) {
+            ptrdiff_t maxOffset = length - hint;
+            while (offset < maxOffset && comp(s[base + hint + offset], key)) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            offset = std::min(offset, maxOffset);
+            lastOffset += hint;
+            offset += hint;
+        } else {
+            ptrdiff_t maxOffset = hint + 1;
+            while (offset < maxOffset && !comp(s[base + hint - offset], key)) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            offset = std::min(offset, maxOffset);
+            ptrdiff_t t = lastOffset;
+            lastOffset = hint - offset;
+            offset = hint - t;
+        }
+        ++lastOffset;
+        while (lastOffset < offset) {
+            ptrdiff_t mid = lastOffset + (offset - lastOffset) / 2;
+            if (comp(s[base + mid], key)) lastOffset = mid + 1;
+            else offset = mid;
+        }
+        return offset;
+    }
+
+    // Index of the first element of s[base..base+length) greater than key
+    template <class It>
+    ptrdiff_t gallopRight(const T& key, It s, ptrdiff_t base, ptrdiff_t length, ptrdiff_t hint) {
+        ptrdiff_t lastOffset = 0, offset = 1;
+        if (comp(key, s[base + hint])) {
+            ptrdiff_t maxOffset = hint + 1;
+            while (offset < maxOffset && comp(key, s[base + hint - offset])) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            offset = std::min(offset, maxOffset);
+            ptrdiff_t t = lastOffset;
+            lastOffset = hint - offset;
+            offset = hint - t;
+        } else {
+            ptrdiff_t maxOffset = length - hint;
+            while (offset < maxOffset && !comp(key, s[base + hint + offset])) {
+                lastOffset = offset;
+                offset = offset * 2 + 1;
+            }
+            offset = std::min(offset, maxOffset);
+            lastOffset += hint;
+            offset += hint;
+        }
+        ++lastOffset;
+        while (lastOffset < offset) {
+            ptrdiff_t mid = lastOffset + (offset - lastOffset) / 2;
+            if (comp(key, s[base + mid])) offset = mid;
+            else lastOffset = mid + 1;
+        }
+        return offset;
+    }
+
+    void mergeAt(size_t i) {
+        ptrdiff_t base1 = runs[i].base, length1 = runs[i].length;
+        ptrdiff_t base2 = runs[i + 1].base, length2 = runs[i + 1].length;
+        runs[i].length = length1 + length2;
+        runs.erase(runs.begin() + i + 1);
+
+        // Elements of run 1 before run 2's first, and of run 2 after run 1's last, stay put
+        ptrdiff_t k = gallopRight(a[base2], a, base1, length1, 0);
+        base1 += k;
+        length1 -= k;
+        if (length1 == 0) return;
+        length2 = gallopLeft(a[base1 + length1 - 1], a, base2, length2, length2 - 1);
+        if (length2 == 0) return;
+
+        if (length1 <= length2) mergeLow(base1, length1, base2, length2);
+        else mergeHigh(base1, length1, base2, length2);
+    }
+
+    TmpIt moveToTmp(ptrdiff_t base, ptrdiff_t length) {
+        tmp.clear();
+        tmp.insert(tmp.end(), std::make_move_iterator(a + base), std::make_move_iterator(a + base + length));
+        return tmp.begin();
+    }
+
+    // Merge front to back with run 1 (the shorter) moved out to tmp
+    void mergeLow(ptrdiff_t base1, ptrdiff_t length1, ptrdiff_t base2, ptrdiff_t length2) {
+        TmpIt t = moveToTmp(base1, length1);
+        ptrdiff_t cursor1 = 0, cursor2 = base2, dest = base1;
+        a[dest++] = std::move(a[cursor2++]); // run 2 starts below run 1's first (see mergeAt)
+        if (--length2 == 0) {
+            std::move(t + cursor1, t + cursor1 + length1, a + dest);
+            return;
+        }
+        if (length1 == 1) {
+            std::move(a + cursor2, a + cursor2 + length2, a + dest);
+            a[dest + length2] = std::move(t[cursor1]);
+            return;
+        }
+
+        int gallop = minGallop;
+        for (;;) {
+            int count1 = 0, count2 = 0; // how many times in a row each run has won
+            bool done = false;
+            // One element at a time until a run wins 'gallop' times in a row
+            while (!done && (count1 | count2) < gallop) {
+                if (comp(a[cursor2], t[cursor1])) {
+                    a[dest++] = std::move(a[cursor2++]);
+                    ++count2;
+                    count1 = 0;
+                    done = --length2 == 0;
+                } else {
+                    a[dest++] = std::move(t[cursor1++]);
+                    ++count1;
+                    count2 = 0;
+                    done = --length1 == 1;
+                }
+            }
+            if (done) break;
+
+            // Galloping: move whole blocks while it keeps paying off
+            do {
+                count1 = (int)gallopRight(a[cursor2], t, cursor1, length1, 0);
+                if (count1 != 0) {
+                    std::move(t + cursor1, t + cursor1 + count1, a + dest);
+                    dest += count1;
+                    cursor1 += count1;
+                    length1 -= count1;
+                    if (length1 <= 1) { done = true; break; }
+                }
+                a[dest++] = std::move(a[cursor2++]);
+                if (--length2 == 0) { done = true; break; }
+
+                count2 = (int)gallopLeft(t[cursor1], a, cursor2, length2, 0);
+                if (count2 != 0) {
+                    std::move(a + cursor2, a + cursor2 + count2, a + dest);
+                    dest += count2;
+                    cursor2 += count2;
+                    length2 -= count2;
+                    if (length2 == 0) { done = true; break; }
+                }
+                a[dest++] = std::move(t[cursor1++]);
+                if (--length1 == 1) { done = true; break; }
+                --gallop;
+            } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+            if (done) break;
+            gallop = std::max(gallop, 0) + 2; // penalty for leaving galloping mode
+        }
+        minGallop = std::max(gallop, 1);
+
+        if (length1 == 1) {
+            std::move(a + cursor2, a + cursor2 + length2, a + dest);
+            a[dest + length2] = std::move(t[cursor1]); // run 1's last belongs after all of run 2
+        } else {
+            std::move(t + cursor1, t + cursor1 + length1, a + dest);
+        }
+    }
+
+    // Merge back to front with run 2 (the shorter) moved out to tmp
+    void mergeHigh(ptrdiff_t base1, ptrdiff_t length1, ptrdiff_t base2, ptrdiff_t length2) {
+        TmpIt t = moveToTmp(base2, length2);
+        ptrdiff_t cursor1 = base1 + length1 - 1, cursor2 = length2 - 1, dest = base2 + length2 - 1;
+        a[dest--] = std::move(a[cursor1--]); // run 1 ends above run 2's last (see mergeAt)
+        if (--length1 == 0) {
+            std::move(t, t + length2, a + (dest - (length2 - 1)));
+            return;
+        }
+        if (length2 == 1) {
+            dest -= length1;
+            cursor1 -= length1;
+            std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + length1, a + dest + 1 + length1);
+            a[dest] = std::move(t[cursor2]);
+            return;
+        }
+
+        int gallop = minGallop;
+        for (;;) {
+            int count1 = 0, count2 = 0;
+            bool done = false;
+            while (!done && (count1 | count2) < gallop) {
+                if (comp(t[cursor2], a[cursor1])) {
+                    a[dest--] = std::move(a[cursor1--]);
+                    ++count1;
+                    count2 = 0;
+                    done = --length1 == 0;
+                } else {
+                    a[dest--] = std::move(t[cursor2--]);
+                    ++count2;
+                    count1 = 0;
+                    done = --length2 == 1;
+                }
+            }
+            if (done) break;
+
+            do {
+                count1 = (int)(length1 - gallopRight(t[cursor2], a, base1, length1, length1 - 1));
+                if (count1 != 0) {
+                    dest -= count1;
+                    cursor1 -= count1;
+                    length1 -= count1;
+                    std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + count1, a + dest + 1 + count1);
+                    if (length1 == 0) { done = true; break; }
+                }
+                a[dest--] = std::move(t[cursor2--]);
+                if (--length2 == 1) { done = true; break; }
+
+                count2 = (int)(length2 - gallopLeft(a[cursor1], t, 0, length2, length2 - 1));
+                if (count2 != 0) {
+                    dest -= count2;
+                    cursor2 -= count2;
+                    length2 -= count2;
+                    std::move(t + cursor2 + 1, t + cursor2 + 1 + count2, a + dest + 1);
+                    if (length2 <= 1) { done = true; break; }
+                }
+                a[dest--] = std::move(a[cursor1--]);
+                if (--length1 == 0) { done = true; break; }
+                --gallop;
+            } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+            if (done) break;
+            gallop = std::max(gallop, 0) + 2;
+        }
+        minGallop = std::max(gallop, 1);
+
+        if (length2 == 1) {
+            dest -= length1;
+            cursor1 -= length1;
+            std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + length1, a + dest + 1 + length1);
+            a[dest] = std::move(t[cursor2]); // run 2's first belongs before all of run 1
+        } else {
+            std::move(t, t + length2, a + (dest - (length2 - 1)));
+        }
+    }
+};
+
+} // namespace detail
+
+// Stable sort that is O(n) on sorted or reversed input and fast on nearly sorted input
+template <class RandomIt, class F>
+void adaptiveSort(RandomIt first, RandomIt last, F compareOrKey) {
+    auto comp = detail::asComparator<detail::ValueType<RandomIt>>(compareOrKey);
+    detail::AdaptiveSorter<RandomIt, decltype(comp)>(first, comp).sort(last - first);
+}
+
+template <class RandomIt>
+void adaptiveSort(RandomIt first, RandomIt last) { adaptiveSort(first, last, std::less<>()); }
+
+// ------------------------------- Task Pool -------------------------------
+
+// Work-stealing task pool: each worker pushes the tasks it forks onto its own deque and
+// pops them newest-first (cache-warm, depth-first); an idle worker steals the oldest task
+// of another worker, which is the biggest piece of work still waiting.
+class TaskPool {
+public:
+    explicit TaskPool(int numThreads) : workers(std::max(1, numThreads)) {
+        for (int w = 1; w < (int)workers.size(); ++w)
+            threads.emplace_back([this, w] { workerLoop(w); });
+    }
+
+    ~TaskPool() {
+        stopping = true;
+        for (std::thread& t : threads) t.join();
+    }
+
+    // Runs 'root' on the calling thread, which acts as worker 0 until it returns. The thread's
+    // previous pool (if run() is called from another pool's task) is restored afterwards.
+    void run(const std::function<void()>& root) {
+        auto previous = current();
+        current() = { this, 0 };
+        try {
+            root();
+        } catch (...) {
+            current() = previous;
+            throw;
+        }
+        current() = previous;
+    }
+
+    // Queues a task (only valid from inside run(), i.e. on a pool thread)
+    void spawn(std::function<void()> task) {
+        Worker& self = workers[current().worker];
+        std::lock_guard<std::mutex> lock(self.lock);
+        self.tasks.push_back(std::move(task));
+    }
+
+    // Waits for 'pending' to reach zero, running other tasks instead of blocking
+    void waitFor(const std::atomic<int>& pending) {
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (!runOne(current().worker)) std::this_thread::yield();
+        }
+    }
+
+    int size() const { return (int)workers.size(); }
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct ThreadSlot {
+        TaskPool* pool;
+        int worker;
+    };
+
+    std::vector<Worker> workers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping{ false };
+
+    // Which pool and worker the calling thread belongs to (a function-local thread_local
+    // keeps the header free of out-of-line definitions)
+    static ThreadSlot& current() {
+        static thread_local ThreadSlot slot{ nullptr, 0 };
+        return slot;
+    }
+
+    // Runs one task: own newest first, otherwise steal another worker's oldest
+    bool runOne(int self) {
+        std::function<void()> task;
+        {
+            Worker& own = workers[self];
+            std::lock_guard<std::mutex> lock(own.lock);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+        for (int k = 1; !task && k < (int)workers.size(); ++k) {
+            Worker& victim = workers[(self + k) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        task();
+        return true;
+    }
+
+    void workerLoop(int self) {
+        current() = { this, self };
+        while (!stopping) {
+            if (!runOne(self)) std::this_thread::yield();
+        }
+    }
+};
+
+// Runs body(0) .. body(chunks - 1) as pool tasks and waits for all of them
+template <class Body>
+void runChunks(TaskPool& pool, int chunks, const Body& body) {
+    std::atomic<int> pending(chunks);
+    for (int c = 0; c < chunks; ++c) {
+        pool.spawn([&body, &pending, c] {
+            body(c);
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+    pool.waitFor(pending);
+}
+
+// --------------------------- Parallel Merge Sort ---------------------------
+
+namespace detail {
+
+// For output position k of the stable merge of a[0..na) and b[0..nb), returns how many of the
+// first k outputs come from a. Binary search on the split i (j = k - i): a split is right when
+// b[j-1] < a[i], i.e. no element of a still belongs before it.
+template <class It, class Compare>
+ptrdiff_t coRank(ptrdiff_t k, It a, ptrdiff_t na, It b, ptrdiff_t nb, Compare& comp) {
+    ptrdiff_t lo = std::max<ptrdiff_t>(0, k - nb), hi = std::min(k, na);
+    while (lo < hi) {
+        ptrdiff_t i = lo + (hi - lo) / 2;
+        ptrdiff_t j = k - i;
+        if (j > 0 && i < na && !comp(b[j - 1], a[i])) lo = i + 1; // a[i] is needed in the prefix
+        else hi = i;
+    }
+    return lo;
+}
+
+// mergeHalves split into independent output chunks at co-ranks
+template <class Src, class Dst, class Compare>
+void parallelMergeHalves(Src src, ptrdiff_t mid, ptrdiff_t n, Dst dst, Compare& comp, TaskPool& pool) {
+    ptrdiff_t chunks = std::min<ptrdiff_t>(pool.size() * 4, (n + PARALLEL_MERGE_CHUNK - 1) / PARALLEL_MERGE_CHUNK);
+    if (chunks <= 1 || !comp(src[mid], src[mid - 1])) {
+        mergeHalves(src, mid, n, dst, comp);
+        return;
+    }
+    Src a = src, b = src + mid;
+    ptrdiff_t na = mid, nb = n - mid;
+    // All split points first: once a chunk starts moving out of src, its elements are gone
+    std::vector<ptrdiff_t> split(chunks + 1);
+    for (ptrdiff_t c = 0; c <= chunks; ++c) split[c] = coRank(n * c / chunks, a, na, b, nb, comp);
+    runChunks(pool, (int)chunks, [=, &split, &comp](int c) {
+        ptrdiff_t k0 = n * c / chunks, k1 = n * (c + 1) / chunks;
+        ptrdiff_t i0 = split[c], i1 = split[c + 1];
+        moveMerge(a + i0, a + i1, b + (k0 - i0), b + (k1 - i1), dst + k0, comp);
+    });
+}
+
+// sortInto with the left half forked as a task and a parallel merge
+template <class ItA, class ItB, class Compare>
+void parallelSortInto(ItA a, ItB b, ptrdiff_t n, bool resultInB, Compare& comp, TaskPool& pool) {
+    if (n <= PARALLEL_SORT_CUTOFF || pool.size() == 1) {
+        sortInto(a, b, n, resultInB, comp);
+        return;
+    }
+    ptrdiff_t mid = n / 2;
+    std::atomic<int> pending(1);
+    pool.spawn([=, &comp, &pool, &pending] {
+        parallelSortInto(a, b, mid, !resultInB, comp, pool);
+        pending.fetch_sub(1, std::memory_order_release);
+    });
+    parallelSortInto(a + mid, b + mid, n - mid, !resultInB, comp, pool);
+    pool.waitFor(pending);
+    if (resultInB) parallelMergeHalves(a, mid, n, b, comp, pool);
+    else parallelMergeHalves(b, mid, n, a, comp, pool);
+}
+
+} // namespace detail
+
+// Stable merge sort on 'threads' threads
+template <class RandomIt, class F>
+void parallelMergeSort(RandomIt first, RandomIt last, F compareOrKey, int threads) {
+    auto comp = detail::asComparator<detail::ValueType<RandomIt>>(compareOrKey);
+    ptrdiff_t n = last - first;
+    if (n <= detail::PARALLEL_SORT_CUTOFF || threads <= 1) {
+        mergeSort(first, last, comp);
+        return;
+    }
+    std::vector<detail::ValueType<RandomIt>> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    TaskPool pool(threads);
+    pool.run([&] { detail::parallelSortInto(buffer.begin(), first, n, true, comp, pool); });
+}
+
+// ------------------------------- Radix Sort -------------------------------
+
+// The radix sorts order elements by an unsigned key of at most 32 bits, returned by 'key'
+// (use SignedIntKey for ints). They need no comparisons: O(n) per digit pass.
+
+namespace detail {
+
+template <class RandomIt, class Key>
+using RadixKeyType = std::decay_t<std::invoke_result_t<Key&, const ValueType<RandomIt>&>>;
+
+// Scratch array for a radix sort. Default-constructible elements get an empty buffer and start
+// in the input range; others are moved into the buffer (which then holds the data).
+template <class RandomIt>
+std::vector<ValueType<RandomIt>> radixBuffer(RandomIt first, RandomIt last, bool& dataInBuffer) {
+    using T = ValueType<RandomIt>;
+    dataInBuffer = !std::is_default_constructible_v<T>;
+    if constexpr (std::is_default_constructible_v<T>) return std::vector<T>(last - first);
+    else return std::vector<T>(std::make_move_iterator(first), std::make_move_iterator(last));
+}
+
+// Moves src[begin..end) to dst at the next free position of each element's bucket
+template <class Src, class Dst, class Key>
+void scatter(Src src, size_t begin, size_t end, Dst dst, size_t* next, int shift, uint32_t mask, Key& key) {
+    for (size_t i = begin; i < end; ++i) {
+        uint32_t digit = ((uint32_t)std::invoke(key, src[i]) >> shift) & mask;
+        dst[next[digit]++] = std::move(src[i]);
+    }
+}
+
+} // namespace detail
+
+// LSD radix sort on DigitBits-bit digits (8 = 4 passes, 11 = 3 passes). The histograms of all
+// digits are counted in one read up front; a pass whose digit is the same for every element
+// is skipped.
+template <int DigitBits, class RandomIt, class Key>
+void radixSort(RandomIt first, RandomIt last, Key key) {
+    using KeyT = detail::RadixKeyType<RandomIt, Key>;
+    static_assert(std::is_unsigned_v<KeyT> && sizeof(KeyT) <= 4, "radix keys must be unsigned and at most 32 bits");
+    constexpr uint32_t buckets = 1u << DigitBits, mask = buckets - 1;
+    constexpr int passes = (32 + DigitBits - 1) / DigitBits;
+
+    size_t n = last - first;
+    if (n < 2) return;
+    std::vector<size_t> counts((size_t)passes * buckets, 0);
+    for (RandomIt it = first; it != last; ++it) {
+        uint32_t k = std::invoke(key, *it);
+        for (int pass = 0; pass < passes; ++pass)
+            counts[pass * buckets + ((k >> (pass * DigitBits)) & mask)]++;
+    }
+
+    bool inBuffer;
+    auto buffer = detail::radixBuffer(first, last, inBuffer);
+    for (int pass = 0; pass < passes; ++pass) {
+        size_t* next = &counts[pass * buckets];
+        if (std::find(next, next + buckets, n) != next + buckets) continue; // one digit for everything
+
+        // Counts become the first output index of each bucket
+        size_t start = 0;
+        for (uint32_t b = 0; b < buckets; ++b) {
+            size_t c = next[b];
+            next[b] = start;
+            start += c;
+        }
+        if (inBuffer) detail::scatter(buffer.begin(), 0, n, first, next, pass * DigitBits, mask, key);
+        else detail::scatter(first, 0, n, buffer.begin(), next, pass * DigitBits, mask, key);
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer) std::move(buffer.begin(), buffer.end(), first);
+}
+
+// 8-bit LSD radix sort on 'threads' threads. Each pass every chunk of the input counts its
+// own histogram, the per-chunk histograms give each chunk its own output positions in every
+// bucket, and the chunks then scatter independently (so the sort stays stable).
+template <class RandomIt, class Key>
+void parallelRadixSort(RandomIt first, RandomIt last, Key key, int threads) {
+    using KeyT = detail::RadixKeyType<RandomIt, Key>;
+    static_assert(std::is_unsigned_v<KeyT> && sizeof(KeyT) <= 4, "radix keys must be unsigned and at most 32 bits");
+    size_t n = last - first;
+    if (n < detail::PARALLEL_RADIX_CUTOFF || threads <= 1) {
+        radixSort<8>(first, last, key);
+        return;
+    }
+    TaskPool pool(threads);
+    const int chunks = pool.size();
+    std::vector<size_t> counts((size_t)chunks * 256);
+    bool inBuffer;
+    auto buffer = detail::radixBuffer(first, last, inBuffer);
+
+    pool.run([&] {
+        for (int shift = 0; shift < 32; shift += 8) {
+            runChunks(pool, chunks, [&](int c) {
+                size_t* count = &counts[(size_t)c * 256];
+                std::fill(count, count + 256, 0);
+                for (size_t i = n * c / chunks; i < n * (c + 1) / chunks; ++i) {
+                    const auto& x = inBuffer ? buffer[i] : first[i];
+                    count[((uint32_t)std::invoke(key, x) >> shift) & 255]++;
+                }
+            });
+
+            // Bucket-major prefix sum: chunk c writes bucket b after chunks 0..c-1
+            size_t start = 0;
+            bool oneBucket = false;
+            for (int b = 0; b < 256; ++b) {
+                size_t bucketStart = start;
+                for (int c = 0; c < chunks; ++c) {
+                    size_t cnt = counts[(size_t)c * 256 + b];
+                    counts[(size_t)c * 256 + b] = start;
+                    start += cnt;
+                }
+                if (start - bucketStart == n) oneBucket = true;
+            }
+            if (oneBucket) continue; // every element has this digit
+
+            runChunks(pool, chunks, [&](int c) {
+                size_t* next = &counts[(size_t)c * 256];
+                size_t begin = n * c / chunks, end = n * (c + 1) / chunks;
+                if (inBuffer) detail::scatter(buffer.begin(), begin, end, first, next, shift, 255, key);
+                else detail::scatter(first, begin, end, buffer.begin(), next, shift, 255, key);
+            });
+            inBuffer = !inBuffer;
+        }
+    });
+    if (inBuffer) std::move(buffer.begin(), buffer.end(), first);
+}
+
+// ----------------------------- External Sort -----------------------------
+
+// Sorts a binary file of fixed-size records (any trivially copyable T, stored as raw bytes)
+// that may be far larger than memory:
+//   1. run formation: read chunks that fit the memory budget with one large read each, sort
+//      them with parallelMergeSort and write each as a sorted run file;
+//   2. merging: k-way merge runs through a loser tree (k - 1 comparisons per log k levels),
+//      with one large buffer per input run and one for the output. If the budget cannot give
+//      every run a useful buffer, runs are merged in several passes.
+// Stable: equal records keep their input order. I/O errors throw std::runtime_error.
+
+struct ExternalSortOptions {
+    size_t memoryBudget = 256u << 20; // bytes for record buffers (chunk + sort scratch, or merge buffers)
+    int threads = 1;                  // threads sorting each chunk
+    std::string tempDirectory;        // run files; empty = the output file's directory
+};
+
+struct ExternalSortStats {
+    unsigned long long records = 0;
+    unsigned long long bytesRead = 0;    // including run files read back
+    unsigned long long bytesWritten = 0; // including run files
+    int initialRuns = 0;
+    int mergePasses = 0;
+    double runSeconds = 0;               // reading, sorting and writing the runs
+    double mergeSeconds = 0;
+};
+
+namespace detail {
+
+// Merge buffers smaller than this make the disk seek more than it transfers
+constexpr size_t MIN_MERGE_BUFFER = 1u << 20;
+
+inline void throwIo(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+class BinaryFile {
+public:
+    BinaryFile(const std::string& filePath, const char* mode) : path(filePath), file(std::fopen(filePath.c_str(), mode)) {
+        if (!file) throwIo("cannot open", path);
+    }
+    ~BinaryFile() { if (file) std::fclose(file); }
+    BinaryFile(const BinaryFile&) = delete;
+    BinaryFile& operator=(const BinaryFile&) = delete;
+
+    size_t read(void* data, size_t bytes) {
+        size_t got = std::fread(data, 1, bytes, file);
+        if (got < bytes && std::ferror(file)) throwIo("cannot read", path);
+        return got;
+    }
+    void write(const void* data, size_t bytes) {
+        if (std::fwrite(data, 1, bytes, file) != bytes) throwIo("cannot write", path);
+    }
+    void close() {
+        FILE* f = file;
+        file = nullptr;
+        if (std::fclose(f) != 0) throwIo("cannot close", path);
+    }
+
+    std::string path;
+
+private:
+    FILE* file;
+};
+
+// One sorted run being merged: refilled a whole buffer at a time
+template <class T>
+class RunReader {
+public:
+    RunReader(const std::string& path, size_t bufferRecords, ExternalSortStats& totals)
+        : file(path, "rb"), buffer(bufferRecords), stats(totals) { refill(); }
+
+    bool done() const { return position == count; }
+    const T& head() const { return buffer[position]; }
+    void pop() { if (++position == count) refill(); }
+
+private:
+    BinaryFile file;
+    std::vector<T> buffer;
+    size_t position = 0, count = 0;
+    ExternalSortStats& stats;
+
+    void refill() {
+        size_t bytes = file.read(buffer.data(), buffer.size() * sizeof(T));
+        stats.bytesRead += bytes;
+        count = bytes / sizeof(T);
+        position = 0;
+    }
+};
+
+// Tournament tree whose internal nodes remember the loser of each match, so replacing the
+// winner only replays the matches on its own leaf-to-root path. Ties go to the lower source
+// index (the earlier run), which keeps the merge stable.
+template <class T, class Compare>
+class LoserTree {
+public:
+    LoserTree(std::vector<std::unique_ptr<RunReader<T>>>& runs, Compare& compare)
+        : sources(runs), comp(compare) {
+        leaves = 1;
+        while (leaves < (int)sources.size()) leaves *= 2;
+        tree.assign(leaves, 0);
+        tree[0] = leaves == 1 ? 0 : build(1);
+    }
+
+    int winner() const { return tree[0]; }
+    bool done() const { return exhausted(tree[0]); }
+
+    // Call after the winner's source has advanced
+    void replay() {
+        int s = tree[0];
+        for (int node = (s + leaves) / 2; node >= 1; node /= 2) {
+            if (beats(tree[node], s)) std::swap(tree[node], s);
+        }
+        tree[0] = s;
+    }
+
+private:
+    std::vector<std::unique_ptr<RunReader<T>>>& sources;
+    Compare& comp;
+    int leaves;
+    std::vector<int> tree; // tree[0] = winner, tree[1..leaves) = losers
+
+    bool exhausted(int s) const { return s >= (int)sources.size() || sources[s]->done(); }
+
+    bool beats(int i, int j) const {
+        if (exhausted(i)) return false;
+        if (exhausted(j)) return true;
+        if (comp(sources[j]->head(), sources[i]->head())) return false;
+        return comp(sources[i]->head(), sources[j]->head()) || i < j;
+    }
+
+    int build(int node) {
+        if (node >= leaves) return node - leaves;
+        int left = build(2 * node), right = build(2 * node + 1);
+        if (beats(left, right)) {
+            tree[node] = right;
+            return left;
+        }
+        tree[node] = left;
+        return right;
+    }
+};
+
+// Merges the sorted run files 'inputs' into 'outputPath'
+template <class T, class Compare>
+void mergeRunFiles(const std::vector<std::string>& inputs, const std::string& outputPath, size_t bufferRecords,
+                   Compare& comp, ExternalSortStats& stats) {
+    std::vector<std::unique_ptr<RunReader<T>>> sources;
+    for (const std::string& path : inputs)
+        sources.push_back(std::make_unique<RunReader<T>>(path, bufferRecords, stats));
+    BinaryFile out(outputPath, "wb");
+    std::vector<T> outBuffer;
+    outBuffer.reserve(bufferRecords);
+
+    LoserTree<T, Compare> tree(sources, comp);
+    while (!tree.done()) {
+        RunReader<T>& source = *sources[tree.winner()];
+        outBuffer.push_back(source.head());
+        source.pop();
+        tree.replay();
+        if (outBuffer.size() == bufferRecords) {
+            out.write(outBuffer.data(), outBuffer.size() * sizeof(T));
+            stats.bytesWritten += outBuffer.size() * sizeof(T);
+            outBuffer.clear();
+        }
+    }
+    out.write(outBuffer.data(), outBuffer.size() * sizeof(T));
+    stats.bytesWritten += outBuffer.size() * sizeof(T);
+    out.close();
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace detail
+
+template <class T, class F>
+ExternalSortStats externalSort(const std::string& inputPath, const std::string& outputPath, F compareOrKey,
+                               const ExternalSortOptions& options = ExternalSortOptions()) {
+    static_assert(std::is_trivially_copyable_v<T>, "external sort stores records as raw bytes");
+    auto comp = detail::asComparator<T>(compareOrKey);
+    ExternalSortStats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    // Run formation: the chunk and parallelMergeSort's scratch copy share the budget
+    size_t chunkRecords = std::max<size_t>(1, options.memoryBudget / (2 * sizeof(T)));
+    std::string tempDirectory = options.tempDirectory;
+    if (tempDirectory.empty()) {
+        tempDirectory = std::filesystem::absolute(outputPath).parent_path().string();
+    }
+    std::string tempPrefix = (std::filesystem::path(tempDirectory) /
+        ("extsort-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "-")).string();
+    int nextRunId = 0;
+    std::vector<std::string> runs, next; // runs of the current and the next merge pass
+    auto newRunPath = [&] { return tempPrefix + std::to_string(nextRunId++) + ".run"; };
+    auto removeRuns = [](const std::vector<std::string>& paths) {
+        for (const std::string& path : paths) std::remove(path.c_str());
+    };
+
+    try {
+        detail::BinaryFile in(inputPath, "rb");
+        // No bigger than the input (+1 so reading a small file whole still ends with a short read)
+        std::error_code sizeError;
+        uintmax_t inputBytes = std::filesystem::file_size(inputPath, sizeError);
+        if (!sizeError) chunkRecords = (size_t)std::min<uintmax_t>(chunkRecords, inputBytes / sizeof(T) + 1);
+        std::vector<T> chunk(chunkRecords);
+        for (;;) {
+            size_t bytes = in.read(chunk.data(), chunkRecords * sizeof(T));
+            size_t count = bytes / sizeof(T);
+            stats.bytesRead += bytes;
+            if (bytes % sizeof(T) != 0) throw std::runtime_error("input size is not a whole number of records: " + inputPath);
+            if (count == 0 && !runs.empty()) break;
+            stats.records += count;
+            parallelMergeSort(chunk.begin(), chunk.begin() + count, comp, options.threads);
+
+            bool last = count < chunkRecords;
+            // A single chunk is the whole answer: write it straight to the output
+            std::string path = (last && runs.empty()) ? outputPath : newRunPath();
+            if (path != outputPath) runs.push_back(path);
+            detail::BinaryFile out(path, "wb");
+            out.write(chunk.data(), count * sizeof(T));
+            out.close();
+            stats.bytesWritten += count * sizeof(T);
+            if (last) break;
+        }
+        stats.initialRuns = std::max<int>(1, (int)runs.size());
+        stats.runSeconds = detail::secondsSince(start);
+
+        // Merge passes: each run and the output get an equal share of the budget
+        auto mergeStart = std::chrono::steady_clock::now();
+        size_t buffers = options.memoryBudget / detail::MIN_MERGE_BUFFER;
+        size_t fanIn = buffers > 3 ? buffers - 1 : 2;
+        while (!runs.empty()) {
+            next.clear();
+            bool finalPass = runs.size() <= fanIn;
+            for (size_t group = 0; group < runs.size(); group += fanIn) {
+                std::vector<std::string> inputs(runs.begin() + group, runs.begin() + std::min(runs.size(), group + fanIn));
+                std::string path = finalPass ? outputPath : newRunPath();
+                size_t bufferRecords = std::max<size_t>(1, options.memoryBudget / ((inputs.size() + 1) * sizeof(T)));
+                detail::mergeRunFiles<T>(inputs, path, bufferRecords, comp, stats);
+                removeRuns(inputs);
+                if (!finalPass) next.push_back(path);
+            }
+            ++stats.mergePasses;
+            runs.swap(next);
+        }
+        stats.mergeSeconds = detail::secondsSince(mergeStart);
+    } catch (...) {
+        removeRuns(runs);
+        removeRuns(next);
+        throw;
+    }
+    return stats;
+}
+
+} // namespace sorts
+
+#endif // SORTLIB_H
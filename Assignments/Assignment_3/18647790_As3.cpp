@@ -6,6 +6,13 @@ Student Number: 18647790
 */
 
 #include <bits/stdc++.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>     // for open
+#include <sys/mman.h>  // for mmap, munmap
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for ftruncate, close
+#define HAVE_MMAP 1
+#endif
 using namespace std;
 
 // --------------------------- Utility Pretty Printers ----------------------------
@@ -16,6 +23,1611 @@ static string padRight(const string &s, size_t width) {
     return s + string(width - s.size(), ' ');
 }
 
+// Fixed-point number as text (for aligned benchmark tables)
+static string formatFixed(double value, int decimals) {
+    ostringstream out;
+    out << fixed << setprecision(decimals) << value;
+    return out.str();
+}
+
+// ------------------------------ Parallel Helpers -------------------------------
+// Runs body(begin, end) over [0, count) in chunks of 'grain', shared out to 'threads' workers
+template <class F>
+void parallelFor(int threads, size_t count, size_t grain, F body) {
+    grain = max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    threads = (int)max<size_t>(1, min<size_t>(threads, chunks));
+    if (threads == 1) {
+        if (count > 0) body(size_t(0), count);
+        return;
+    }
+    atomic<size_t> nextChunk{0};
+    auto worker = [&]() {
+        for (size_t c; (c = nextChunk.fetch_add(1)) < chunks;) {
+            body(c * grain, min(count, (c + 1) * grain));
+        }
+    };
+    vector<thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool) t.join();
+}
+
+// Same chunked loop as parallelFor, but the worker threads are started once and then parked
+// between run() calls, for callers that run many short parallel steps (one per BFS level)
+class WorkerTeam {
+public:
+    explicit WorkerTeam(int threads) {
+        for (int i = 1; i < threads; ++i) workers.emplace_back([this]() { workerLoop(); });
+    }
+    WorkerTeam(const WorkerTeam &) = delete;
+    WorkerTeam &operator=(const WorkerTeam &) = delete;
+    ~WorkerTeam() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+    template <class F>
+    void run(size_t count, size_t grain, F body) {
+        grain = max<size_t>(grain, 1);
+        size_t chunks = (count + grain - 1) / grain;
+        if (workers.empty() || chunks <= 1) {
+            if (count > 0) body(size_t(0), count);
+            return;
+        }
+        function<void(size_t, size_t)> task = body;
+        {
+            lock_guard<mutex> guard(lock);
+            job = &task;
+            jobCount = count;
+            jobGrain = grain;
+            jobChunks = chunks;
+            nextChunk = 0;
+            busy = workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        work(); // the calling thread takes chunks too
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [&]() { return busy == 0; });
+        job = nullptr;
+    }
+
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, done;
+    bool stopping = false;
+    size_t generation = 0, busy = 0;
+    const function<void(size_t, size_t)> *job = nullptr;
+    size_t jobCount = 0, jobGrain = 1, jobChunks = 0;
+    atomic<size_t> nextChunk{0};
+
+    void work() {
+        for (size_t c; (c = nextChunk.fetch_add(1)) < jobChunks;) {
+            (*job)(c * jobGrain, min(jobCount, (c + 1) * jobGrain));
+        }
+    }
+    void workerLoop() {
+        size_t seen = 0;
+        unique_lock<mutex> guard(lock);
+        for (;;) {
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            guard.unlock();
+            work();
+            guard.lock();
+            if (--busy == 0) done.notify_one();
+        }
+    }
+};
+
+// ------------------------------ Graph Storage ----------------------------------
+/*
+Storage layouts (XAI):
+- AdjacencyListView reads Graph::adj directly: one heap vector per city, easy to grow
+  while the graph is being built, but a traversal jumps between scattered allocations.
+- CsrGraph is a frozen "compressed sparse row" copy: the edges of vertex u are
+  targets/weights[offsets[u] .. offsets[u+1]), all in two contiguous arrays. Optionally the
+  vertices are renumbered in BFS order so neighbours get nearby numbers and nearby memory.
+- Both offer vertexCount(), forEachEdge(u, f(v, km)) and forEachEdgeUntil(u, f(v, km)), which
+  stops as soon as f returns true, so one BFS / Dijkstra implementation runs on either.
+*/
+
+struct AdjacencyListView {
+    const vector<vector<pair<int,int>>> *adj;
+
+    int vertexCount() const { return (int)adj->size(); }
+    int degree(int u) const { return (int)(*adj)[u].size(); }
+    size_t edgeCount() const {
+        size_t m = 0;
+        for (const auto &edges : *adj) m += edges.size();
+        return m;
+    }
+
+    template <class F>
+    void forEachEdge(int u, F &&f) const {
+        for (auto [v, km] : (*adj)[u]) f(v, km);
+    }
+
+    // Like forEachEdge, but stops at the first edge where f returns true; returns whether it did
+    template <class F>
+    bool forEachEdgeUntil(int u, F &&f) const {
+        for (auto [v, km] : (*adj)[u]) {
+            if (f(v, km)) return true;
+        }
+        return false;
+    }
+};
+
+class CsrGraph {
+public:
+    vector<int> offsets;    // size n + 1
+    vector<int> targets;    // size m (each undirected road appears twice)
+    vector<int> weights;    // size m, km
+    vector<int> toInternal; // original city index -> CSR vertex (identity unless renumbered)
+    vector<int> toExternal; // CSR vertex -> original city index
+
+    int vertexCount() const { return (int)offsets.size() - 1; }
+    int degree(int u) const { return offsets[u + 1] - offsets[u]; }
+    size_t edgeCount() const { return targets.size(); }
+
+    template <class F>
+    void forEachEdge(int u, F &&f) const {
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) f(targets[e], weights[e]);
+    }
+
+    template <class F>
+    bool forEachEdgeUntil(int u, F &&f) const {
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+            if (f(targets[e], weights[e])) return true;
+        }
+        return false;
+    }
+
+    // Bytes used by the arrays (for comparing layouts)
+    size_t memoryBytes() const {
+        return (offsets.size() + targets.size() + weights.size() + toInternal.size() + toExternal.size()) * sizeof(int);
+    }
+
+    // Builds the CSR copy of an adjacency list; 'renumber' orders vertices by BFS discovery
+    static CsrGraph build(const vector<vector<pair<int,int>>> &adj, bool renumber) {
+        CsrGraph g;
+        const int n = (int)adj.size();
+        g.toExternal.reserve(n);
+        if (renumber) {
+            // BFS from every not-yet-numbered vertex; discovery order = new number
+            vector<char> seen(n, 0);
+            for (int root = 0; root < n; ++root) {
+                if (seen[root]) continue;
+                seen[root] = 1;
+                size_t head = g.toExternal.size();
+                g.toExternal.push_back(root);
+                while (head < g.toExternal.size()) {
+                    int u = g.toExternal[head++];
+                    for (auto [v, km] : adj[u]) {
+                        (void)km;
+                        if (!seen[v]) { seen[v] = 1; g.toExternal.push_back(v); }
+                    }
+                }
+            }
+        } else {
+            for (int u = 0; u < n; ++u) g.toExternal.push_back(u);
+        }
+        g.toInternal.assign(n, 0);
+        for (int i = 0; i < n; ++i) g.toInternal[g.toExternal[i]] = i;
+
+        g.offsets.assign(n + 1, 0);
+        for (int i = 0; i < n; ++i) g.offsets[i + 1] = g.offsets[i] + (int)adj[g.toExternal[i]].size();
+        g.targets.resize(g.offsets[n]);
+        g.weights.resize(g.offsets[n]);
+        for (int i = 0; i < n; ++i) {
+            int e = g.offsets[i];
+            for (auto [v, km] : adj[g.toExternal[i]]) {
+                g.targets[e] = g.toInternal[v];
+                g.weights[e] = km;
+                ++e;
+            }
+        }
+        return g;
+    }
+};
+
+// BFS visiting order from s on any graph view (vertex numbers of that view)
+template <class G>
+vector<int> bfsOrderOn(const G &g, int s) {
+    vector<int> order;
+    vector<int> visited(g.vertexCount(), 0);
+    queue<int> q;
+    visited[s] = 1;
+    q.push(s);
+
+    while (!q.empty()) {
+        int u = q.front(); q.pop();
+        order.push_back(u);
+        g.forEachEdge(u, [&](int v, int km) {
+            (void)km; // distance not needed for BFS ordering
+            if (!visited[v]) {
+                visited[v] = 1;
+                q.push(v);
+            }
+        });
+    }
+    return order;
+}
+
+// -------------------------------- Priority Queues --------------------------------
+/*
+Dijkstra's queue, four interchangeable versions (XAI):
+- All offer empty(), push(km, v) and pop() -> (km, v) with the smallest km. Dijkstra skips a
+  popped (km, v) when km is no longer dist[v], so lazy queues may hold outdated copies.
+- BinaryHeapQueue: std::priority_queue with lazy deletion (the original). Simple, but every
+  improvement adds an entry, and each pop costs O(log of all entries, stale ones included).
+- FourAryHeapQueue: an indexed heap with 4 children per node and a position table, so an
+  improvement lowers v's one entry in place ("decrease-key"). Never stale, shallower than a
+  binary heap, and a node's children sit next to each other in memory.
+- RadixHeapQueue: uses the fact that Dijkstra pops distances in increasing order. Entries
+  are kept in 33 buckets by the highest bit in which they differ from the last popped
+  distance; each entry only ever moves to lower buckets, so O(1) push and amortised
+  O(log C) pop for integer km.
+- DialQueue: one bucket per km value, scanned in order (a circular array whose size grows to
+  the largest distance span in the queue, about the longest road). Best when road lengths
+  are small integers.
+*/
+enum class QueueKind { BinaryHeap, FourAryHeap, RadixHeap, Dial };
+
+inline const char *queueKindName(QueueKind kind) {
+    switch (kind) {
+        case QueueKind::BinaryHeap:  return "binary heap (lazy)";
+        case QueueKind::FourAryHeap: return "indexed 4-ary heap";
+        case QueueKind::RadixHeap:   return "radix heap";
+        case QueueKind::Dial:        return "dial buckets";
+    }
+    return "?";
+}
+
+class BinaryHeapQueue {
+public:
+    explicit BinaryHeapQueue(int n) { (void)n; }
+    bool empty() const { return heap.empty(); }
+    void push(int key, int v) { heap.push({key, v}); }
+    pair<int,int> pop() {
+        pair<int,int> top = heap.top();
+        heap.pop();
+        return top;
+    }
+
+private:
+    priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> heap;
+};
+
+class FourAryHeapQueue {
+public:
+    explicit FourAryHeapQueue(int n) : position(n, -1) {}
+    bool empty() const { return heap.empty(); }
+
+    // Insert v, or lower its key if it is already queued with a larger one
+    void push(int key, int v) {
+        int i = position[v];
+        if (i < 0) {
+            i = (int)heap.size();
+            heap.push_back({key, v});
+        } else if (key < heap[i].first) {
+            heap[i].first = key;
+        } else {
+            return;
+        }
+        siftUp(i);
+    }
+
+    pair<int,int> pop() {
+        pair<int,int> top = heap[0];
+        position[top.second] = -1;
+        pair<int,int> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            position[last.second] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+private:
+    vector<pair<int,int>> heap; // (key, vertex)
+    vector<int> position;       // vertex -> index in heap, -1 if not queued
+
+    void siftUp(int i) {
+        pair<int,int> item = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / 4;
+            if (heap[parent].first <= item.first) break;
+            heap[i] = heap[parent];
+            position[heap[i].second] = i;
+            i = parent;
+        }
+        heap[i] = item;
+        position[item.second] = i;
+    }
+
+    void siftDown(int i) {
+        pair<int,int> item = heap[i];
+        const int size = (int)heap.size();
+        while (true) {
+            int first = 4 * i + 1;
+            if (first >= size) break;
+            int best = first;
+            for (int c = first + 1; c < min(first + 4, size); ++c) {
+                if (heap[c].first < heap[best].first) best = c;
+            }
+            if (heap[best].first >= item.first) break;
+            heap[i] = heap[best];
+            position[heap[i].second] = i;
+            i = best;
+        }
+        heap[i] = item;
+        position[item.second] = i;
+    }
+};
+
+class RadixHeapQueue {
+public:
+    explicit RadixHeapQueue(int n) { (void)n; }
+    bool empty() const { return count == 0; }
+
+    // Keys must not be below the last popped key (true for Dijkstra)
+    void push(int key, int v) {
+        buckets[bucketOf((unsigned)key)].push_back({key, v});
+        ++count;
+    }
+
+    pair<int,int> pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) ++i;
+            // new 'last' = smallest key in bucket i; every entry there moves to a lower bucket
+            unsigned smallest = UINT_MAX;
+            for (auto &entry : buckets[i]) smallest = min(smallest, (unsigned)entry.first);
+            last = smallest;
+            for (auto &entry : buckets[i]) buckets[bucketOf((unsigned)entry.first)].push_back(entry);
+            buckets[i].clear();
+        }
+        pair<int,int> top = buckets[0].back();
+        buckets[0].pop_back();
+        --count;
+        return top;
+    }
+
+private:
+    array<vector<pair<int,int>>, 33> buckets;
+    unsigned last = 0;
+    size_t count = 0;
+
+    int bucketOf(unsigned key) const { return key == last ? 0 : 32 - __builtin_clz(key ^ last); }
+};
+
+class DialQueue {
+public:
+    explicit DialQueue(int n) : buckets(64) { (void)n; }
+    bool empty() const { return count == 0; }
+
+    // Keys must not be below the last popped key (true for Dijkstra)
+    void push(int key, int v) {
+        while ((size_t)(key - current) >= buckets.size()) grow();
+        buckets[key & (buckets.size() - 1)].push_back({key, v});
+        ++count;
+    }
+
+    pair<int,int> pop() {
+        const size_t mask = buckets.size() - 1;
+        while (buckets[current & mask].empty()) ++current;
+        pair<int,int> top = buckets[current & mask].back();
+        buckets[current & mask].pop_back();
+        --count;
+        return top;
+    }
+
+private:
+    vector<vector<pair<int,int>>> buckets; // power-of-two circular array, one key per bucket
+    int current = 0;                       // smallest key that may still be queued
+    size_t count = 0;
+
+    void grow() {
+        vector<vector<pair<int,int>>> bigger(buckets.size() * 2);
+        for (auto &bucket : buckets) {
+            for (auto &entry : bucket) bigger[entry.first & (bigger.size() - 1)].push_back(entry);
+        }
+        buckets.swap(bigger);
+    }
+};
+
+// Calls f(queueTag) with QueueTag<the queue class for 'kind'>; use typename decltype(tag)::type
+template <class Q> struct QueueTag { using type = Q; };
+
+template <class F>
+decltype(auto) withQueue(QueueKind kind, F &&f) {
+    switch (kind) {
+        case QueueKind::FourAryHeap: return f(QueueTag<FourAryHeapQueue>{});
+        case QueueKind::RadixHeap:   return f(QueueTag<RadixHeapQueue>{});
+        case QueueKind::Dial:        return f(QueueTag<DialQueue>{});
+        default:                     return f(QueueTag<BinaryHeapQueue>{});
+    }
+}
+
+// Work counter for comparing point-to-point searches
+struct SearchStats {
+    size_t settled = 0; // vertices taken out of the queue with their final distance
+};
+
+// Dijkstra from s, stopping at t, on any graph view: {distance, route} or {INT_MAX, {}}
+template <class Queue = BinaryHeapQueue, class G>
+pair<int, vector<int>> dijkstraOn(const G &g, int s, int t, SearchStats *stats = nullptr) {
+    const int n = g.vertexCount();
+    const int INF = 1e9;
+
+    vector<int> dist(n, INF);
+    vector<int> parent(n, -1);
+    // min-queue of (distanceSoFar, node)
+    Queue pq(n);
+
+    dist[s] = 0;
+    pq.push(0, s);
+
+    while (!pq.empty()) {
+        auto [d, u] = pq.pop();
+        if (d != dist[u]) continue; // skip stale entry
+        if (stats) ++stats->settled;
+        if (u == t) break;          // we can stop early if we reached dest
+
+        g.forEachEdge(u, [&](int v, int w) {
+            if (dist[v] > dist[u] + w) {
+                dist[v] = dist[u] + w;
+                parent[v] = u;
+                pq.push(dist[v], v);
+            }
+        });
+    }
+
+    if (dist[t] >= INF) {
+        return {INT_MAX, {}}; // no path exists
+    }
+
+    // Reconstruct path from t back to s using parent[]
+    vector<int> route;
+    for (int cur = t; cur != -1; cur = parent[cur]) {
+        route.push_back(cur);
+    }
+    reverse(route.begin(), route.end());
+    return {dist[t], route};
+}
+
+// Dijkstra from s to every vertex: dist[v] in km, or 1e9 if unreachable
+template <class Queue = BinaryHeapQueue, class G>
+void shortestDistancesOn(const G &g, int s, vector<int> &dist) {
+    const int INF = 1e9;
+    dist.assign(g.vertexCount(), INF);
+    Queue pq(g.vertexCount());
+    dist[s] = 0;
+    pq.push(0, s);
+    while (!pq.empty()) {
+        auto [d, u] = pq.pop();
+        if (d != dist[u]) continue; // skip stale entry
+        g.forEachEdge(u, [&](int v, int w) {
+            if (dist[v] > d + w) {
+                dist[v] = d + w;
+                pq.push(dist[v], v);
+            }
+        });
+    }
+}
+
+// Dijkstra from s that stops once all 'targetCount' vertices with isTarget[v] are settled;
+// dist[v] is exact for those targets (and anything settled before them), 1e9 if unreachable
+template <class Queue = BinaryHeapQueue, class G>
+void distancesToTargetsOn(const G &g, int s, const vector<char> &isTarget, size_t targetCount, vector<int> &dist) {
+    const int INF = 1e9;
+    dist.assign(g.vertexCount(), INF);
+    Queue pq(g.vertexCount());
+    dist[s] = 0;
+    pq.push(0, s);
+    size_t settledTargets = 0;
+    while (!pq.empty()) {
+        auto [d, u] = pq.pop();
+        if (d != dist[u]) continue; // skip stale entry
+        if (isTarget[u] && ++settledTargets == targetCount) break;
+        g.forEachEdge(u, [&](int v, int w) {
+            if (dist[v] > d + w) {
+                dist[v] = d + w;
+                pq.push(dist[v], v);
+            }
+        });
+    }
+}
+
+// ------------------------ Direction-Optimizing BFS -----------------------------
+/*
+Level-by-level BFS (XAI):
+- The visited set is a bitmap: 1 bit per vertex instead of a 4-byte flag.
+- Top-down step: every frontier vertex (kept as a plain list) looks at its neighbours and
+  claims the unvisited ones. Cheap while the frontier is small.
+- Bottom-up step: every UNVISITED vertex looks for any neighbour in the frontier and stops
+  at the first hit. Here the frontier is a bitmap too, so "is u in the frontier?" is one bit
+  test. Cheap when the frontier is huge (the middle levels of low-diameter graphs): the
+  neighbour scan (forEachEdgeUntil) stops at the first frontier neighbour, which with a big
+  frontier is usually one of the first few edges.
+- Switching rule (Beamer et al.): go bottom-up when the frontier's edges exceed 1/14 of the
+  edges still unexplored; go back top-down when the frontier holds fewer than n/24 vertices.
+- With threads > 1 each step is split between threads: top-down claims a vertex with an
+  atomic fetch-or on its visited bit, bottom-up threads own disjoint 64-vertex words so need
+  no atomics at all. One WorkerTeam serves every level, so threads are started once per BFS
+  rather than once per level.
+- Result: hop count and BFS-tree parent for every vertex (-1 = unreachable).
+*/
+struct BfsTree {
+    vector<int> hops;   // edges on the shortest hop path from the start, -1 if unreachable
+    vector<int> parent; // previous vertex on that path (start is its own parent), -1 if unreachable
+    int levels = 0;     // number of BFS levels processed
+    int bottomUpLevels = 0;
+};
+
+template <class G>
+BfsTree directionOptimizingBfs(const G &g, int s, int threads = 1, bool allowBottomUp = true) {
+    const int n = g.vertexCount();
+    const size_t words = ((size_t)n + 63) / 64;
+    const long long alpha = 14, beta = 24;
+    const bool parallel = threads > 1;
+    WorkerTeam team(threads);
+
+    BfsTree tree;
+    tree.hops.assign(n, -1);
+    tree.parent.assign(n, -1);
+    vector<uint64_t> visited(words, 0), frontierBits, nextBits;
+    vector<int> frontier = {s}; // top-down levels keep the frontier as a vertex list
+
+    tree.hops[s] = 0;
+    tree.parent[s] = s;
+    visited[s >> 6] |= uint64_t(1) << (s & 63);
+    long long frontierSize = 1;
+    long long frontierEdges = g.degree(s);
+    long long unexploredEdges = (long long)g.edgeCount() - frontierEdges;
+    bool bottomUp = false;
+
+    for (int level = 0; frontierSize > 0; ++level) {
+        bool wasBottomUp = bottomUp;
+        if (allowBottomUp) {
+            if (!bottomUp && frontierEdges > unexploredEdges / alpha) bottomUp = true;
+            else if (bottomUp && frontierSize < n / beta) bottomUp = false;
+        }
+        // Convert the frontier when the direction changes
+        if (bottomUp && !wasBottomUp) {
+            frontierBits.assign(words, 0);
+            for (int u : frontier) frontierBits[u >> 6] |= uint64_t(1) << (u & 63);
+            nextBits.assign(words, 0);
+        } else if (!bottomUp && wasBottomUp) {
+            frontier.clear();
+            for (size_t w = 0; w < words; ++w) {
+                for (uint64_t bits = frontierBits[w]; bits; bits &= bits - 1) {
+                    frontier.push_back((int)(w * 64 + __builtin_ctzll(bits)));
+                }
+            }
+        }
+        atomic<long long> nextSize{0}, nextEdges{0};
+
+        if (bottomUp) {
+            team.run(words, 256, [&](size_t wb, size_t we) {
+                long long foundCount = 0, foundEdges = 0;
+                for (size_t w = wb; w < we; ++w) {
+                    uint64_t todo = ~visited[w];
+                    if (w == words - 1 && (n & 63)) todo &= (uint64_t(1) << (n & 63)) - 1;
+                    uint64_t found = 0;
+                    while (todo) {
+                        int bit = __builtin_ctzll(todo);
+                        todo &= todo - 1;
+                        int v = (int)(w * 64 + bit);
+                        bool hit = g.forEachEdgeUntil(v, [&](int u, int km) {
+                            (void)km;
+                            if (!((frontierBits[u >> 6] >> (u & 63)) & 1)) return false;
+                            tree.parent[v] = u;
+                            return true;
+                        });
+                        if (hit) {
+                            tree.hops[v] = level + 1;
+                            found |= uint64_t(1) << bit;
+                            ++foundCount;
+                            foundEdges += g.degree(v);
+                        }
+                    }
+                    nextBits[w] = found;
+                    visited[w] |= found;
+                }
+                nextSize += foundCount;
+                nextEdges += foundEdges;
+            });
+            swap(frontierBits, nextBits);
+            ++tree.bottomUpLevels;
+        } else {
+            vector<int> next;
+            mutex nextLock;
+            team.run(frontier.size(), 1024, [&](size_t fb, size_t fe) {
+                vector<int> found;
+                long long foundEdges = 0;
+                for (size_t i = fb; i < fe; ++i) {
+                    int u = frontier[i];
+                    g.forEachEdge(u, [&](int v, int km) {
+                        (void)km;
+                        uint64_t mask = uint64_t(1) << (v & 63);
+                        if (parallel) {
+                            if (__atomic_load_n(&visited[v >> 6], __ATOMIC_RELAXED) & mask) return;
+                            if (__atomic_fetch_or(&visited[v >> 6], mask, __ATOMIC_RELAXED) & mask) return;
+                        } else {
+                            if (visited[v >> 6] & mask) return;
+                            visited[v >> 6] |= mask;
+                        }
+                        tree.parent[v] = u;
+                        tree.hops[v] = level + 1;
+                        found.push_back(v);
+                        foundEdges += g.degree(v);
+                    });
+                }
+                nextEdges += foundEdges;
+                if (parallel) {
+                    lock_guard<mutex> guard(nextLock);
+                    next.insert(next.end(), found.begin(), found.end());
+                } else {
+                    next.swap(found);
+                }
+            });
+            nextSize = (long long)next.size();
+            frontier.swap(next);
+        }
+
+        frontierSize = nextSize;
+        frontierEdges = nextEdges;
+        unexploredEdges -= frontierEdges;
+        tree.levels = level + 1;
+    }
+    return tree;
+}
+
+// ------------------------------ Memory-Mapped Files ----------------------------
+/*
+MappedFile (XAI):
+- Maps a whole file into memory with mmap: the OS loads pages only when they are touched,
+  so "opening" a big precomputed file is almost free and it is shared between processes.
+- create() makes a read-write file of a given size; openReadOnly() maps an existing one.
+- The mapping is released in the destructor (move-only, like unique_ptr). Errors throw
+  runtime_error with the file name.
+- Without mmap (e.g. MinGW on Windows) the file is read into an ordinary buffer instead, and
+  a create()d file is written back from its buffer when the MappedFile is destroyed. Same
+  interface, only the "almost free" opening is lost.
+*/
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept { swapWith(other); }
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        swapWith(other);
+        return *this;
+    }
+    ~MappedFile() {
+#ifdef HAVE_MMAP
+        if (base) munmap(base, bytes);
+#else
+        if (!writeBackPath.empty()) {
+            ofstream out(writeBackPath, ios::binary | ios::trunc);
+            out.write(buffer.data(), (streamsize)buffer.size());
+            if (!out) cerr << "Error: write failed: " << writeBackPath << "\n"; // destructors cannot throw
+        }
+#endif
+    }
+
+    char *data() { return static_cast<char *>(base); }
+    const char *data() const { return static_cast<const char *>(base); }
+    size_t size() const { return bytes; }
+
+    static MappedFile create(const string &path, size_t size) {
+#ifdef HAVE_MMAP
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw runtime_error("cannot create " + path);
+        if (ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            throw runtime_error("cannot resize " + path);
+        }
+        return mapDescriptor(fd, size, true, path);
+#else
+        if (!ofstream(path, ios::binary | ios::trunc)) throw runtime_error("cannot create " + path);
+        MappedFile f;
+        f.buffer.assign(size, 0);
+        f.base = f.buffer.data();
+        f.bytes = size;
+        f.writeBackPath = path;
+        return f;
+#endif
+    }
+
+    static MappedFile openReadOnly(const string &path) {
+#ifdef HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("cannot open " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw runtime_error("cannot read size of " + path);
+        }
+        return mapDescriptor(fd, (size_t)info.st_size, false, path);
+#else
+        ifstream in(path, ios::binary | ios::ate);
+        if (!in) throw runtime_error("cannot open " + path);
+        MappedFile f;
+        f.buffer.resize((size_t)in.tellg());
+        in.seekg(0);
+        in.read(f.buffer.data(), (streamsize)f.buffer.size());
+        if (!in) throw runtime_error("cannot read " + path);
+        f.base = f.buffer.data();
+        f.bytes = f.buffer.size();
+        return f;
+#endif
+    }
+
+private:
+    void *base = nullptr;
+    size_t bytes = 0;
+#ifndef HAVE_MMAP
+    vector<char> buffer;  // the file's bytes (no mmap)
+    string writeBackPath; // create()d files are saved here on destruction
+#endif
+
+    void swapWith(MappedFile &other) noexcept {
+        swap(base, other.base);
+        swap(bytes, other.bytes);
+#ifndef HAVE_MMAP
+        buffer.swap(other.buffer);
+        writeBackPath.swap(other.writeBackPath);
+#endif
+    }
+
+#ifdef HAVE_MMAP
+    static MappedFile mapDescriptor(int fd, size_t size, bool writable, const string &path) {
+        MappedFile f;
+        if (size > 0) {
+            void *p = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw runtime_error("cannot map " + path);
+            }
+            f.base = p;
+            f.bytes = size;
+        }
+        close(fd);
+        return f;
+    }
+#endif
+};
+
+// -------------------------- All-Pairs Distance Table ---------------------------
+/*
+All-pairs shortest distances (XAI):
+- DistanceTable keeps every answer in ONE contiguous n x n block of ints (row u = distances
+  from city u), so a lookup is a single multiply-add: cells[u * n + v]. The block is either
+  normal memory or a memory-mapped file, which a later run can map again without recomputing.
+- Floyd–Warshall (blocked): for every k, d[i][j] = min(d[i][j], d[i][k] + d[k][j]). It is done
+  in 64 x 64 tiles, so each tile (16 KB) stays in the L1 cache while it is reused 64 times:
+  first the diagonal tile of the k-block, then its row and column tiles, then all other
+  tiles (those are independent, so they run in parallel). O(n^3), best for small dense graphs.
+- Repeated Dijkstra: one full Dijkstra per source, sources spread over threads, each thread
+  writing only its own rows. O(n * E log V), best for large sparse graphs like road networks.
+- Unreachable pairs hold INF (1e9); INF + INF still fits in an int, so no overflow checks.
+*/
+enum class ApspMethod { Automatic, FloydWarshall, RepeatedDijkstra };
+
+class DistanceTable {
+public:
+    static constexpr int INF = 1000000000;
+
+    DistanceTable() = default;
+    explicit DistanceTable(int cities) : n(cities), owned((size_t)cities * cities, INF) { cells = owned.data(); }
+
+    int size() const { return n; }
+    int at(int u, int v) const { return cells[(size_t)u * n + v]; }
+    bool reachable(int u, int v) const { return at(u, v) < INF; }
+    int *row(int u) { return cells + (size_t)u * n; }
+    const int *row(int u) const { return cells + (size_t)u * n; }
+
+    // File layout: "APSP" magic, int32 n, then n*n int32 cells (native byte order)
+    static DistanceTable createFile(const string &path, int n) {
+        DistanceTable t;
+        t.file = MappedFile::create(path, HEADER_BYTES + (size_t)n * n * sizeof(int));
+        memcpy(t.file.data(), "APSP", 4);
+        memcpy(t.file.data() + 4, &n, sizeof(int));
+        t.n = n;
+        t.cells = reinterpret_cast<int *>(t.file.data() + HEADER_BYTES);
+        fill(t.cells, t.cells + (size_t)n * n, INF);
+        return t;
+    }
+    static DistanceTable openFile(const string &path) {
+        DistanceTable t;
+        t.file = MappedFile::openReadOnly(path);
+        int n = -1;
+        if (t.file.size() >= HEADER_BYTES) memcpy(&n, t.file.data() + 4, sizeof(int));
+        if (n < 0 || memcmp(t.file.data(), "APSP", 4) != 0 ||
+            t.file.size() != HEADER_BYTES + (size_t)n * n * sizeof(int)) {
+            throw runtime_error(path + " is not a distance table");
+        }
+        t.n = n;
+        t.cells = reinterpret_cast<int *>(t.file.data() + HEADER_BYTES);
+        return t;
+    }
+
+private:
+    static constexpr size_t HEADER_BYTES = 8;
+    int n = 0;
+    int *cells = nullptr; // points into 'owned' or into 'file' (both keep their address on move)
+    vector<int> owned;
+    MappedFile file;
+};
+
+// Distances from a list of sources (rows) to a list of targets (columns), one contiguous
+// row-major block; cells are DistanceTable::INF where no route exists
+class DistanceMatrix {
+public:
+    static constexpr int INF = DistanceTable::INF;
+
+    DistanceMatrix() = default;
+    DistanceMatrix(int rows, int cols) : rowCount(rows), colCount(cols), cells((size_t)rows * cols, INF) {}
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int at(int i, int j) const { return cells[(size_t)i * colCount + j]; }
+    bool reachable(int i, int j) const { return at(i, j) < INF; }
+    int *row(int i) { return cells.data() + (size_t)i * colCount; }
+    const int *row(int i) const { return cells.data() + (size_t)i * colCount; }
+    const int *data() const { return cells.data(); }
+    bool operator==(const DistanceMatrix &other) const {
+        return rowCount == other.rowCount && colCount == other.colCount && cells == other.cells;
+    }
+
+private:
+    int rowCount = 0, colCount = 0;
+    vector<int> cells;
+};
+
+// Blocked Floyd–Warshall on the n x n table (which already holds direct roads and 0 diagonal)
+inline void blockedFloydWarshall(DistanceTable &table, int threads) {
+    const int B = 64;
+    const int n = table.size();
+    const int N = (n + B - 1) / B * B; // padded size, a whole number of tiles
+    const int tiles = N / B;
+    const int INF = DistanceTable::INF;
+
+    vector<int> d((size_t)N * N, INF);
+    for (int i = 0; i < n; ++i) copy(table.row(i), table.row(i) + n, d.begin() + (size_t)i * N);
+
+    // Tile (ib, jb) += tile (ib, kb) (x) tile (kb, jb); k outermost keeps in-place updates correct
+    auto relax = [&](int ib, int jb, int kb) {
+        for (int k = kb * B; k < kb * B + B; ++k) {
+            const int *rowK = &d[(size_t)k * N + jb * B];
+            for (int i = ib * B; i < ib * B + B; ++i) {
+                int dik = d[(size_t)i * N + k];
+                if (dik >= INF) continue;
+                int *rowI = &d[(size_t)i * N + jb * B];
+                for (int j = 0; j < B; ++j) rowI[j] = min(rowI[j], dik + rowK[j]);
+            }
+        }
+    };
+
+    // Same update for tiles outside row/column kb: their inputs are already final for this kb,
+    // so i can be the outer loop and row i's 64 cells stay in a local (register) buffer.
+    auto relaxIndependent = [&](int ib, int jb, int kb) {
+        int acc[B];
+        for (int i = ib * B; i < ib * B + B; ++i) {
+            int *rowI = &d[(size_t)i * N + jb * B];
+            const int *dik = &d[(size_t)i * N + kb * B];
+            copy(rowI, rowI + B, acc);
+            for (int k = 0; k < B; ++k) {
+                if (dik[k] >= INF) continue;
+                const int *rowK = &d[(size_t)(kb * B + k) * N + jb * B];
+                for (int j = 0; j < B; ++j) acc[j] = min(acc[j], dik[k] + rowK[j]);
+            }
+            copy(acc, acc + B, rowI);
+        }
+    };
+
+    for (int kb = 0; kb < tiles; ++kb) {
+        relax(kb, kb, kb);
+        parallelFor(threads, (size_t)tiles, 1, [&](size_t b, size_t e) {
+            for (size_t t = b; t < e; ++t) {
+                if ((int)t == kb) continue;
+                relax(kb, (int)t, kb); // row tiles
+                relax((int)t, kb, kb); // column tiles
+            }
+        });
+        parallelFor(threads, (size_t)tiles, 1, [&](size_t b, size_t e) {
+            for (size_t ib = b; ib < e; ++ib) {
+                if ((int)ib == kb) continue;
+                for (int jb = 0; jb < tiles; ++jb) {
+                    if (jb != kb) relaxIndependent((int)ib, jb, kb);
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < n; ++i) copy(d.begin() + (size_t)i * N, d.begin() + (size_t)i * N + n, table.row(i));
+}
+
+// ----------------------------- Point-to-Point Search ----------------------------
+/*
+Faster single route queries (XAI):
+- Bidirectional Dijkstra grows one search from the source and one from the target (roads are
+  two-way, so the backward search uses the same edges) and always advances the side whose
+  next distance is smaller. Every edge seen from both sides offers a candidate route; we stop
+  once the two next distances add up to at least the best candidate. Two half-size "balls"
+  settle far fewer cities than one ball reaching all the way to the target.
+- A* orders the queue by distance-so-far + estimate(v), a lower bound on the km still needed
+  from v to the target, so the search is pulled towards the target. Estimates used here:
+  * straight line: the chord between the two points on the Earth (never longer than the
+    great-circle arc), scaled down if any road is shorter than the line between its ends;
+  * ALT landmarks: with exact road km from a few far-apart "landmark" cities L,
+    |d(L, t) - d(L, v)| <= d(v, t) by the triangle inequality; take the best landmark.
+  Both are consistent (h(u) <= km(u, v) + h(v)), so every city is settled at most once and
+  the first time the target is settled its distance is exact.
+*/
+template <class G>
+pair<int, vector<int>> bidirectionalDijkstraOn(const G &g, int s, int t, SearchStats *stats = nullptr) {
+    const int n = g.vertexCount();
+    const int INF = 1e9;
+    if (s == t) {
+        if (stats) ++stats->settled;
+        return {0, {s}};
+    }
+
+    // side 0 searches forward from s, side 1 backward from t
+    vector<int> dist[2] = {vector<int>(n, INF), vector<int>(n, INF)};
+    vector<int> parent[2] = {vector<int>(n, -1), vector<int>(n, -1)};
+    priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq[2];
+    dist[0][s] = 0;
+    dist[1][t] = 0;
+    pq[0].push({0, s});
+    pq[1].push({0, t});
+    int best = INF, meet = -1;
+
+    while (!pq[0].empty() && !pq[1].empty()) {
+        if (pq[0].top().first + pq[1].top().first >= best) break;
+        int side = pq[0].top().first <= pq[1].top().first ? 0 : 1;
+        auto [d, u] = pq[side].top(); pq[side].pop();
+        if (d != dist[side][u]) continue; // skip stale entry
+        if (stats) ++stats->settled;
+
+        vector<int> &mine = dist[side];
+        const vector<int> &other = dist[1 - side];
+        g.forEachEdge(u, [&](int v, int w) {
+            if (mine[v] > d + w) {
+                mine[v] = d + w;
+                parent[side][v] = u;
+                pq[side].push({mine[v], v});
+            }
+            if (other[v] < INF && d + w + other[v] < best) {
+                best = d + w + other[v];
+                meet = v;
+            }
+        });
+    }
+
+    if (best >= INF) return {INT_MAX, {}};
+    // s .. meet from the forward parents, then meet .. t from the backward parents
+    vector<int> route;
+    for (int cur = meet; cur != -1; cur = parent[0][cur]) route.push_back(cur);
+    reverse(route.begin(), route.end());
+    for (int cur = parent[1][meet]; cur != -1; cur = parent[1][cur]) route.push_back(cur);
+    return {best, route};
+}
+
+// A* from s to t; estimate(v) must be a consistent lower bound on km from v to t (>= 1e9 = unreachable)
+template <class G, class H>
+pair<int, vector<int>> aStarOn(const G &g, int s, int t, H &&estimate, SearchStats *stats = nullptr) {
+    const int n = g.vertexCount();
+    const int INF = 1e9;
+
+    vector<int> dist(n, INF);
+    vector<int> parent(n, -1);
+    vector<char> settled(n, 0);
+    // min-heap of (distanceSoFar + estimate, node)
+    priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq;
+
+    dist[s] = 0;
+    if (estimate(s) < INF) pq.push({estimate(s), s});
+
+    while (!pq.empty()) {
+        int u = pq.top().second; pq.pop();
+        if (settled[u]) continue; // stale entry
+        settled[u] = 1;
+        if (stats) ++stats->settled;
+        if (u == t) break;
+
+        g.forEachEdge(u, [&](int v, int w) {
+            if (dist[v] > dist[u] + w) {
+                int h = estimate(v);
+                if (h >= INF) return; // v cannot reach t
+                dist[v] = dist[u] + w;
+                parent[v] = u;
+                pq.push({dist[v] + h, v});
+            }
+        });
+    }
+
+    if (dist[t] >= INF) return {INT_MAX, {}};
+    vector<int> route;
+    for (int cur = t; cur != -1; cur = parent[cur]) route.push_back(cur);
+    reverse(route.begin(), route.end());
+    return {dist[t], route};
+}
+
+// Latitude/longitude in degrees; NaN when a city has no known location
+struct GeoPoint {
+    double lat = NAN;
+    double lon = NAN;
+    bool known() const { return !isnan(lat) && !isnan(lon); }
+};
+
+// Straight-line (chord) distance in km between two points on the Earth's surface
+inline double straightLineKm(const GeoPoint &a, const GeoPoint &b) {
+    const double R = 6371.0, rad = M_PI / 180.0;
+    double dx = cos(a.lat * rad) * cos(a.lon * rad) - cos(b.lat * rad) * cos(b.lon * rad);
+    double dy = cos(a.lat * rad) * sin(a.lon * rad) - cos(b.lat * rad) * sin(b.lon * rad);
+    double dz = sin(a.lat * rad) - sin(b.lat * rad);
+    return R * sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Lower-bound tables for A*, built by Graph::buildRouteHeuristic (city numbering)
+class RouteHeuristic {
+public:
+    static constexpr double EARTH_RADIUS_KM = 6371.0;
+    vector<array<double,3>> unitPoint; // city location on the unit sphere (empty = not used)
+    double kmPerChordUnit = 0;         // Earth radius x admissibility scale
+    int landmarkCount = 0;
+    vector<int> landmarks;             // landmark city indices
+    vector<int> landmarkKm;            // landmarkKm[v * landmarkCount + i] = road km between landmark i and v
+
+    // Lower bound on road km from city v to city t (1e9 if t cannot be reached from v)
+    int estimate(int v, int t) const {
+        const int INF = 1e9;
+        int h = 0;
+        if (!unitPoint.empty()) {
+            double dx = unitPoint[v][0] - unitPoint[t][0];
+            double dy = unitPoint[v][1] - unitPoint[t][1];
+            double dz = unitPoint[v][2] - unitPoint[t][2];
+            h = (int)(kmPerChordUnit * sqrt(dx * dx + dy * dy + dz * dz)); // floor keeps it consistent
+        }
+        const int *fromV = &landmarkKm[(size_t)v * landmarkCount];
+        const int *fromT = &landmarkKm[(size_t)t * landmarkCount];
+        for (int i = 0; i < landmarkCount; ++i) {
+            if (fromV[i] >= INF || fromT[i] >= INF) {
+                if (fromV[i] != fromT[i]) return INF; // only one of them is connected to landmark i
+                continue;
+            }
+            h = max(h, abs(fromT[i] - fromV[i]));
+        }
+        return h;
+    }
+};
+
+// ---------------------------- Contraction Hierarchies ---------------------------
+/*
+Contraction hierarchies (XAI):
+- Preprocessing removes ("contracts") cities one at a time, least important first. When v
+  is removed, every pair of its remaining neighbours u, w whose shortest connection runs
+  through v gets a shortcut u-w of length km(u,v) + km(v,w), remembering v as its middle.
+  A short "witness" Dijkstra from u (avoiding v, capped at 200 settled cities and 50x as many
+  arcs) checks whether some other route is at least as short; if so no shortcut is needed.
+  A neighbour is done as soon as any route to it is short enough, and since arc lists are
+  kept sorted by km the search radius shrinks as the far neighbours are done.
+- Importance = 2 x (shortcuts added - roads removed) + neighbours already contracted + depth,
+  so quiet back roads go first and motorway junctions last; rank[v] is v's position.
+- Lazy updates: contracting v only marks its neighbours stale. When a stale city comes up for
+  contraction, the shortcut count its contraction needs anyway replaces the old estimate,
+  and if that makes it more important than a neighbour it waits for a later round. (Fresh
+  estimates for every neighbour after every contraction took most of the preprocessing.)
+- Parallel rounds: every city whose importance is lower than all its remaining neighbours'
+  is contracted in the same round. These never touch each other, so their witness searches
+  (treating all of this round's cities as already gone) run in parallel; the shortcuts are
+  then added by one thread.
+- Query: a forward search from s and a backward search from t that only ever go UP in rank
+  (shortest routes in the hierarchy always go up then down). Both meet at the top after
+  settling a few hundred cities. "Stall-on-demand" skips a city when a higher one already
+  offers a shorter way to it.
+- Unpacking: every shortcut on the found route is replaced by its two halves (through the
+  middle city) until only real roads remain, giving the same route vector as dijkstraPath.
+- Many-to-many (manyToMany): one upward search per target leaves (target, km) notes in a
+  "bucket" at every city it settles. One upward search per source then reads the buckets of
+  the cities it settles: D[s][t] = min over v of up(s, v) + up(t, v). That is
+  |sources| + |targets| small searches instead of |sources| x |targets| queries.
+*/
+class ContractionHierarchy {
+public:
+    struct Arc {
+        int to;
+        int km;
+        int middle; // city the shortcut skips, -1 for a real road
+    };
+
+    vector<int> rank;      // contraction position: higher = more important
+    vector<int> upOffsets; // CSR: arcs of v to higher-ranked cities are upArcs[upOffsets[v] .. upOffsets[v+1])
+    vector<Arc> upArcs;
+    size_t shortcutCount = 0;
+
+    int vertexCount() const { return (int)rank.size(); }
+
+    static ContractionHierarchy build(const vector<vector<pair<int,int>>> &adj, int threads = 1, int witnessLimit = 200) {
+        const int n = (int)adj.size();
+        vector<vector<Arc>> remaining(n); // uncontracted part of the graph, both directions
+        for (int u = 0; u < n; ++u) {
+            for (auto [v, km] : adj[u]) {
+                if (u != v) addOrImprove(remaining[u], {v, km, -1});
+            }
+        }
+        vector<char> gone(n, 0);          // contracted, or being contracted this round
+        vector<char> stale(n, 0);         // a neighbour was contracted since edgeDifference[v] was found
+        vector<int> edgeDifference(n, 0), contractedNeighbours(n, 0), depth(n, 0);
+        vector<vector<Arc>> upward(n);
+        auto priority = [&](int v) { return 2 * edgeDifference[v] + contractedNeighbours[v] + depth[v]; };
+        auto lessImportant = [&](int u, int v) {
+            int pu = priority(u), pv = priority(v);
+            return pu < pv || (pu == pv && u < v);
+        };
+
+        // the starting order only needs an estimate: a 10x smaller witness search is plenty
+        const int estimateLimit = max(20, witnessLimit / 10);
+        parallelFor(threads, (size_t)n, 256, [&](size_t b, size_t e) {
+            for (size_t v = b; v < e; ++v) {
+                int added = (int)findShortcuts(remaining, gone, (int)v, estimateLimit).size();
+                edgeDifference[v] = added - (int)remaining[v].size();
+            }
+        });
+
+        ContractionHierarchy ch;
+        ch.rank.assign(n, -1);
+        vector<int> left(n);
+        iota(left.begin(), left.end(), 0);
+        int nextRank = 0;
+        while (!left.empty()) {
+            // Independent set: cities less important than every remaining neighbour
+            vector<char> pickFlag(left.size(), 0);
+            parallelFor(threads, left.size(), 1024, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) {
+                    int v = left[i];
+                    bool localMin = true;
+                    for (const Arc &a : remaining[v]) {
+                        if (lessImportant(a.to, v)) { localMin = false; break; }
+                    }
+                    pickFlag[i] = localMin;
+                }
+            });
+            vector<int> picked, stillLeft;
+            for (size_t i = 0; i < left.size(); ++i) (pickFlag[i] ? picked : stillLeft).push_back(left[i]);
+            for (int v : picked) gone[v] = 1;
+
+            vector<vector<pair<int, Arc>>> shortcuts(picked.size()); // (from, arc)
+            parallelFor(threads, picked.size(), 16, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) shortcuts[i] = findShortcuts(remaining, gone, picked[i], witnessLimit);
+            });
+
+            for (size_t i = 0; i < picked.size(); ++i) {
+                int v = picked[i];
+                if (stale[v]) {
+                    // lazy update: the real shortcut count is known now; wait if v is no longer the least important
+                    stale[v] = 0;
+                    edgeDifference[v] = (int)shortcuts[i].size() - (int)remaining[v].size();
+                    bool localMin = true;
+                    for (const Arc &a : remaining[v]) {
+                        if (lessImportant(a.to, v)) { localMin = false; break; }
+                    }
+                    if (!localMin) {
+                        gone[v] = 0;
+                        stillLeft.push_back(v);
+                        continue;
+                    }
+                }
+                ch.rank[v] = nextRank++;
+                upward[v] = move(remaining[v]);
+                remaining[v] = vector<Arc>();
+                for (const Arc &a : upward[v]) {
+                    auto &list = remaining[a.to];
+                    list.erase(remove_if(list.begin(), list.end(), [&](const Arc &x) { return x.to == v; }), list.end());
+                    ++contractedNeighbours[a.to];
+                    depth[a.to] = max(depth[a.to], depth[v] + 1);
+                    stale[a.to] = 1;
+                }
+                for (auto &[u, arc] : shortcuts[i]) {
+                    addOrImprove(remaining[u], arc);
+                    addOrImprove(remaining[arc.to], {u, arc.km, arc.middle});
+                    ++ch.shortcutCount;
+                }
+            }
+            left.swap(stillLeft);
+        }
+
+        ch.upOffsets.assign(n + 1, 0);
+        for (int v = 0; v < n; ++v) ch.upOffsets[v + 1] = ch.upOffsets[v] + (int)upward[v].size();
+        ch.upArcs.reserve(ch.upOffsets[n]);
+        for (int v = 0; v < n; ++v) {
+            ch.upArcs.insert(ch.upArcs.end(), upward[v].begin(), upward[v].end());
+            vector<Arc>().swap(upward[v]);
+        }
+        return ch;
+    }
+
+    // File layout: "CHIE", uint32 version (1), int32 n, int32 0, int64 shortcuts, int64 arcs,
+    // then int32 rank[n], int32 upOffsets[n + 1], and (to, km, middle) int32 triples
+    void save(const string &path) const {
+        ofstream out(path, ios::binary);
+        if (!out) throw runtime_error("cannot create " + path);
+        uint32_t version = 1;
+        int32_t n = vertexCount(), zero = 0;
+        int64_t shortcuts = (int64_t)shortcutCount, arcs = (int64_t)upArcs.size();
+        out.write("CHIE", 4);
+        out.write(reinterpret_cast<const char *>(&version), 4);
+        out.write(reinterpret_cast<const char *>(&n), 4);
+        out.write(reinterpret_cast<const char *>(&zero), 4);
+        out.write(reinterpret_cast<const char *>(&shortcuts), 8);
+        out.write(reinterpret_cast<const char *>(&arcs), 8);
+        out.write(reinterpret_cast<const char *>(rank.data()), (size_t)n * 4);
+        out.write(reinterpret_cast<const char *>(upOffsets.data()), (size_t)(n + 1) * 4);
+        static_assert(sizeof(Arc) == 12, "Arc is written as three int32");
+        out.write(reinterpret_cast<const char *>(upArcs.data()), upArcs.size() * sizeof(Arc));
+        if (!out) throw runtime_error("write failed: " + path);
+    }
+
+    static ContractionHierarchy load(const string &path) {
+        ifstream in(path, ios::binary);
+        if (!in) throw runtime_error("cannot open " + path);
+        char magic[4] = {};
+        uint32_t version = 0;
+        int32_t n = -1, zero;
+        int64_t shortcuts = -1, arcs = -1;
+        in.read(magic, 4);
+        in.read(reinterpret_cast<char *>(&version), 4);
+        in.read(reinterpret_cast<char *>(&n), 4);
+        in.read(reinterpret_cast<char *>(&zero), 4);
+        in.read(reinterpret_cast<char *>(&shortcuts), 8);
+        in.read(reinterpret_cast<char *>(&arcs), 8);
+        if (!in || memcmp(magic, "CHIE", 4) != 0 || version != 1 || n < 0 || arcs < 0 || arcs > INT32_MAX) {
+            throw runtime_error(path + " is not a contraction hierarchy");
+        }
+        if (filesystem::file_size(path) != 32 + (uintmax_t)n * 4 + (uintmax_t)(n + 1) * 4 + (uintmax_t)arcs * sizeof(Arc)) {
+            throw runtime_error(path + " is truncated");
+        }
+        ContractionHierarchy ch;
+        ch.shortcutCount = (size_t)shortcuts;
+        ch.rank.resize(n);
+        ch.upOffsets.resize(n + 1);
+        ch.upArcs.resize(arcs);
+        in.read(reinterpret_cast<char *>(ch.rank.data()), (size_t)n * 4);
+        in.read(reinterpret_cast<char *>(ch.upOffsets.data()), (size_t)(n + 1) * 4);
+        in.read(reinterpret_cast<char *>(ch.upArcs.data()), (size_t)arcs * sizeof(Arc));
+        if (!in || ch.upOffsets[0] != 0 || ch.upOffsets[n] != arcs) throw runtime_error(path + " is truncated");
+
+        // Queries index dist[] with arc targets and unpacking recurses on middles, so check them:
+        // ranks are a permutation, arcs go up in rank, and a shortcut's middle ranks below both ends
+        auto fail = [&]() { throw runtime_error(path + " is not a consistent contraction hierarchy"); };
+        vector<char> rankUsed(n, 0);
+        for (int v = 0; v < n; ++v) {
+            if (ch.rank[v] < 0 || ch.rank[v] >= n || rankUsed[ch.rank[v]]) fail();
+            rankUsed[ch.rank[v]] = 1;
+        }
+        for (int v = 0; v < n; ++v) {
+            if (ch.upOffsets[v + 1] < ch.upOffsets[v]) fail();
+        }
+        for (int v = 0; v < n; ++v) {
+            for (int e = ch.upOffsets[v]; e < ch.upOffsets[v + 1]; ++e) {
+                const Arc &a = ch.upArcs[e];
+                if (a.to < 0 || a.to >= n || ch.rank[a.to] <= ch.rank[v] || a.km < 0) fail();
+                if (a.middle != -1 && (a.middle < 0 || a.middle >= n || ch.rank[a.middle] >= ch.rank[v])) fail();
+            }
+        }
+        return ch;
+    }
+
+    // Reusable search state for one thread: queries cost O(cities touched), not O(n)
+    class Query {
+    public:
+        explicit Query(const ContractionHierarchy &hierarchy) : ch(&hierarchy) {
+            for (int side = 0; side < 2; ++side) {
+                dist[side].assign(hierarchy.vertexCount(), INF);
+                parent[side].assign(hierarchy.vertexCount(), -1);
+            }
+        }
+
+        // {km, route as city indices} or {INT_MAX, {}}; same answer as dijkstraPath
+        pair<int, vector<int>> route(int s, int t, SearchStats *stats = nullptr) {
+            int meet = search(s, t, stats);
+            if (meet < 0) {
+                reset();
+                return {INT_MAX, {}};
+            }
+            int km = dist[0][meet] + dist[1][meet];
+            vector<int> up; // s .. meet .. t in the hierarchy
+            for (int cur = meet; cur != -1; cur = parent[0][cur]) up.push_back(cur);
+            reverse(up.begin(), up.end());
+            for (int cur = parent[1][meet]; cur != -1; cur = parent[1][cur]) up.push_back(cur);
+            reset();
+
+            vector<int> route = {up[0]};
+            for (size_t i = 0; i + 1 < up.size(); ++i) ch->unpack(up[i], up[i + 1], route);
+            return {km, route};
+        }
+
+        // Distance only (skips route reconstruction)
+        int distance(int s, int t, SearchStats *stats = nullptr) {
+            int meet = search(s, t, stats);
+            int km = meet < 0 ? INT_MAX : dist[0][meet] + dist[1][meet];
+            reset();
+            return km;
+        }
+
+    private:
+        static constexpr int INF = 1000000000;
+        const ContractionHierarchy *ch;
+        vector<int> dist[2], parent[2];
+        vector<int> touched;
+
+        int search(int s, int t, SearchStats *stats) {
+            priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq[2];
+            dist[0][s] = 0; touched.push_back(s);
+            dist[1][t] = 0; touched.push_back(t);
+            pq[0].push({0, s});
+            pq[1].push({0, t});
+            int best = INF, meet = -1;
+            while (!pq[0].empty() || !pq[1].empty()) {
+                // a side is finished once its next distance cannot beat the best meeting
+                for (int side = 0; side < 2; ++side) {
+                    if (!pq[side].empty() && pq[side].top().first >= best) pq[side] = {};
+                }
+                int side = pq[0].empty() ? 1 : pq[1].empty() ? 0 : pq[0].top().first <= pq[1].top().first ? 0 : 1;
+                if (pq[side].empty()) break;
+                auto [d, u] = pq[side].top(); pq[side].pop();
+                if (d != dist[side][u]) continue;
+                if (stats) ++stats->settled;
+                if (dist[1 - side][u] < INF && d + dist[1 - side][u] < best) {
+                    best = d + dist[1 - side][u];
+                    meet = u;
+                }
+                // stall-on-demand: a higher city already reaches u more cheaply
+                bool stalled = false;
+                for (int e = ch->upOffsets[u]; e < ch->upOffsets[u + 1] && !stalled; ++e) {
+                    const Arc &a = ch->upArcs[e];
+                    stalled = dist[side][a.to] < INF && dist[side][a.to] + a.km < d;
+                }
+                if (stalled) continue;
+                for (int e = ch->upOffsets[u]; e < ch->upOffsets[u + 1]; ++e) {
+                    const Arc &a = ch->upArcs[e];
+                    if (dist[side][a.to] > d + a.km) {
+                        if (dist[0][a.to] >= INF && dist[1][a.to] >= INF) touched.push_back(a.to);
+                        dist[side][a.to] = d + a.km;
+                        parent[side][a.to] = u;
+                        pq[side].push({d + a.km, a.to});
+                    }
+                }
+            }
+            return meet;
+        }
+
+        void reset() {
+            for (int v : touched) {
+                dist[0][v] = dist[1][v] = INF;
+                parent[0][v] = parent[1][v] = -1;
+            }
+            touched.clear();
+        }
+    };
+
+    // One-off query (allocates a fresh Query; reuse a Query for many routes)
+    pair<int, vector<int>> route(int s, int t) const { return Query(*this).route(s, t); }
+
+    // Distances from every source to every target (row i = sources[i]) using buckets
+    DistanceMatrix manyToMany(const vector<int> &sources, const vector<int> &targets, int threads = 1) const {
+        struct BucketEntry {
+            int column;
+            int km;
+        };
+        const int n = vertexCount();
+        for (const vector<int> *list : {&sources, &targets}) {
+            for (int v : *list) {
+                if (v < 0 || v >= n) throw runtime_error("city index " + to_string(v) + " is out of range");
+            }
+        }
+
+        // Backward: upward search from each target, noting (column, km) at every settled city
+        vector<vector<pair<int, int>>> reached(targets.size()); // per target: (city, km)
+        parallelFor(threads, targets.size(), 16, [&](size_t b, size_t e) {
+            for (size_t j = b; j < e; ++j) {
+                upwardSearch(targets[j], [&](int v, int km) { reached[j].push_back({v, km}); });
+            }
+        });
+        vector<int> bucketOffsets(n + 1, 0);
+        for (const auto &list : reached) {
+            for (auto [v, km] : list) ++bucketOffsets[v + 1];
+        }
+        for (int v = 0; v < n; ++v) bucketOffsets[v + 1] += bucketOffsets[v];
+        vector<BucketEntry> buckets(bucketOffsets[n]);
+        vector<int> fillPos(bucketOffsets.begin(), bucketOffsets.end() - 1);
+        for (size_t j = 0; j < reached.size(); ++j) {
+            for (auto [v, km] : reached[j]) buckets[fillPos[v]++] = {(int)j, km};
+            vector<pair<int, int>>().swap(reached[j]);
+        }
+
+        // Forward: upward search from each source, combining with the buckets it meets
+        DistanceMatrix result((int)sources.size(), (int)targets.size());
+        parallelFor(threads, sources.size(), 16, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                int *row = result.row((int)i);
+                upwardSearch(sources[i], [&](int v, int km) {
+                    for (int k = bucketOffsets[v]; k < bucketOffsets[v + 1]; ++k) {
+                        row[buckets[k].column] = min(row[buckets[k].column], km + buckets[k].km);
+                    }
+                });
+            }
+        });
+        return result;
+    }
+
+private:
+    // Upward-only Dijkstra from s with stall-on-demand; calls visit(v, km) for every city it
+    // settles without stalling. Scratch space is per thread, so searches can run in parallel.
+    template <class Visit>
+    void upwardSearch(int s, Visit visit) const {
+        struct Workspace {
+            vector<int> dist;
+            vector<int> touched;
+        };
+        thread_local Workspace ws;
+        const int INF = 1000000000;
+        if (ws.dist.size() != rank.size()) ws.dist.assign(rank.size(), INF);
+
+        priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq;
+        ws.dist[s] = 0;
+        ws.touched.push_back(s);
+        pq.push({0, s});
+        while (!pq.empty()) {
+            auto [d, u] = pq.top(); pq.pop();
+            if (d != ws.dist[u]) continue;
+            bool stalled = false;
+            for (int e = upOffsets[u]; e < upOffsets[u + 1] && !stalled; ++e) {
+                stalled = ws.dist[upArcs[e].to] < INF && ws.dist[upArcs[e].to] + upArcs[e].km < d;
+            }
+            if (stalled) continue;
+            visit(u, d);
+            for (int e = upOffsets[u]; e < upOffsets[u + 1]; ++e) {
+                const Arc &a = upArcs[e];
+                if (ws.dist[a.to] > d + a.km) {
+                    if (ws.dist[a.to] >= INF) ws.touched.push_back(a.to);
+                    ws.dist[a.to] = d + a.km;
+                    pq.push({d + a.km, a.to});
+                }
+            }
+        }
+        for (int v : ws.touched) ws.dist[v] = INF;
+        ws.touched.clear();
+    }
+
+    // Keeps the shorter of an existing arc to the same city and 'arc'; the list stays sorted
+    // by km so a witness search can stop scanning at the first arc that is too long
+    static void addOrImprove(vector<Arc> &arcs, const Arc &arc) {
+        for (size_t i = 0; i < arcs.size(); ++i) {
+            if (arcs[i].to == arc.to) {
+                if (arc.km >= arcs[i].km) return;
+                arcs.erase(arcs.begin() + i);
+                break;
+            }
+        }
+        auto at = upper_bound(arcs.begin(), arcs.end(), arc.km, [](int km, const Arc &a) { return km < a.km; });
+        arcs.insert(at, arc);
+    }
+
+    // Shortcuts needed if v were contracted now, as (from, arc) with from < arc.to
+    static vector<pair<int, Arc>> findShortcuts(const vector<vector<Arc>> &remaining, const vector<char> &gone,
+                                                int v, int witnessLimit) {
+        struct Workspace {
+            vector<int> dist;
+            vector<int> touched;
+            vector<char> isTarget; // 1 while the pair (u, w) still has no witness
+            vector<int> via;       // km of u-v-w, for targets w
+        };
+        thread_local Workspace ws;
+        const int INF = 1000000000;
+        if (ws.dist.size() != remaining.size()) {
+            ws.dist.assign(remaining.size(), INF);
+            ws.isTarget.assign(remaining.size(), 0);
+            ws.via.assign(remaining.size(), 0);
+        }
+
+        vector<pair<int, Arc>> shortcuts;
+        const vector<Arc> &around = remaining[v];
+        for (size_t i = 0; i < around.size(); ++i) {
+            int u = around[i].to;
+            if (i + 1 == around.size()) break; // no later neighbour to pair u with
+            for (size_t j = i + 1; j < around.size(); ++j) {
+                ws.isTarget[around[j].to] = 1;
+                ws.via[around[j].to] = around[i].km + around[j].km;
+            }
+            int targetsLeft = (int)(around.size() - i - 1);
+            // 'around' is sorted by km, so the farthest open target is the last one; the search
+            // radius shrinks as the far targets get their witness
+            size_t last = around.size() - 1;
+            auto close = [&](int w) {
+                ws.isTarget[w] = 0;
+                --targetsLeft;
+                while (last > i && !ws.isTarget[around[last].to]) --last;
+            };
+
+            // witness search from u, avoiding v and anything already gone; a target is done
+            // once any route to it is no longer than through v, or once it is settled
+            priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq;
+            ws.dist[u] = 0;
+            ws.touched.push_back(u);
+            pq.push({0, u});
+            int settled = 0;
+            long long scanned = 0; // arcs looked at: caps the cost around very busy cities
+            while (!pq.empty() && settled < witnessLimit && scanned < 50LL * witnessLimit && targetsLeft > 0) {
+                auto [d, x] = pq.top(); pq.pop();
+                if (d != ws.dist[x]) continue;
+                int maxVia = ws.via[around[last].to];
+                if (d > maxVia) break;
+                ++settled;
+                if (ws.isTarget[x]) close(x);
+                scanned += (long long)remaining[x].size();
+                for (const Arc &a : remaining[x]) {
+                    if (d + a.km > maxVia) break; // the rest are longer still
+                    if (a.to == v || gone[a.to]) continue;
+                    if (ws.dist[a.to] > d + a.km) {
+                        if (ws.dist[a.to] == INF) ws.touched.push_back(a.to);
+                        ws.dist[a.to] = d + a.km;
+                        pq.push({d + a.km, a.to});
+                        if (ws.isTarget[a.to] && d + a.km <= ws.via[a.to]) close(a.to);
+                    }
+                }
+            }
+            for (size_t j = i + 1; j < around.size(); ++j) {
+                int w = around[j].to;
+                if (ws.dist[w] > ws.via[w]) shortcuts.push_back({u, {w, ws.via[w], v}});
+                ws.isTarget[w] = 0;
+            }
+            for (int x : ws.touched) ws.dist[x] = INF;
+            ws.touched.clear();
+        }
+        return shortcuts;
+    }
+
+    // Appends the real roads of arc a -> b (a already in 'route') by expanding shortcuts
+    void unpack(int a, int b, vector<int> &route) const {
+        vector<pair<int,int>> todo = {{a, b}};
+        while (!todo.empty()) {
+            auto [x, y] = todo.back(); todo.pop_back();
+            const Arc *arc = findArc(x, y);
+            if (arc->middle < 0) {
+                route.push_back(y);
+            } else {
+                todo.push_back({arc->middle, y}); // done second
+                todo.push_back({x, arc->middle}); // done first
+            }
+        }
+    }
+
+    // The arc between x and y, stored at whichever of them has the lower rank
+    const Arc *findArc(int x, int y) const {
+        int low = rank[x] < rank[y] ? x : y, high = low == x ? y : x;
+        for (int e = upOffsets[low]; e < upOffsets[low + 1]; ++e) {
+            if (upArcs[e].to == high) return &upArcs[e];
+        }
+        throw runtime_error("contraction hierarchy is inconsistent");
+    }
+};
+
 // ------------------------------- Graph Class -----------------------------------
 
 class Graph {
@@ -26,11 +1638,18 @@ public:
     - code:     index -> short code for display (e.g., "CT")
     - indexOf:  city name -> index, for quick lookup
     - adj:      adjacency list: adj[u] = vector of (v, distanceKm)
+    - csr:      optional frozen copy of adj for fast traversals (see freeze())
+    - locations: index -> latitude/longitude (optional, used by the A* estimate)
+    - dijkstraQueue: which priority queue Dijkstra uses (see "Priority Queues")
     */
     vector<string> names;
     vector<string> codes;
+    vector<GeoPoint> locations;
     unordered_map<string, int> indexOf;
     vector<vector<pair<int,int>>> adj; // pair: (neighborIndex, distanceKm)
+    CsrGraph csr;
+    bool frozen = false;               // csr is up to date and used by the searches
+    QueueKind dijkstraQueue = QueueKind::BinaryHeap; // queue used by the Dijkstra searches
 
     // Constructor creates N empty lists for N cities
     Graph(int n = 0) {
@@ -40,22 +1659,50 @@ public:
     }
 
     // Add a new city; returns its index
-    int addCity(const string &name, const string &code) {
+    int addCity(const string &name, const string &code, GeoPoint where = GeoPoint()) {
         int idx = (int)names.size();
         names.push_back(name);
         codes.push_back(code);
+        locations.push_back(where);
         indexOf[name] = idx;
         adj.push_back({}); // ensure adjacency list exists
+        frozen = false;    // the CSR copy no longer matches
         return idx;
     }
 
     // Add an undirected edge (road) with a distance in km
     void addUndirectedRoad(const string &fromCity, const string &toCity, int km) {
-        int u = indexOf.at(fromCity);
-        int v = indexOf.at(toCity);
+        addUndirectedRoad(indexOf.at(fromCity), indexOf.at(toCity), km);
+    }
+
+    // Same, by city index (no name lookups)
+    void addUndirectedRoad(int u, int v, int km) {
         // Push both directions because roads are two-way for this model
         adj[u].push_back({v, km});
         adj[v].push_back({u, km});
+        frozen = false;
+    }
+
+    // Build the CSR copy that bfsOrder and dijkstraPath then run on (until the graph changes)
+    void freeze(bool renumber = false) {
+        csr = CsrGraph::build(adj, renumber);
+        frozen = true;
+    }
+
+    // Drop the CSR copy and go back to searching the adjacency list
+    void unfreeze() {
+        csr = CsrGraph();
+        frozen = false;
+    }
+
+    // Runs search(view, from, to, cityOf) on the adjacency list or on the CSR copy, where
+    // cityOf maps a view vertex back to a city index; the route is returned as city indices
+    template <class Search>
+    pair<int, vector<int>> searchCurrentLayout(int s, int t, Search &&search) const {
+        if (!frozen) return search(AdjacencyListView{&adj}, s, t, [](int v) { return v; });
+        auto result = search(csr, csr.toInternal[s], csr.toInternal[t], [this](int v) { return csr.toExternal[v]; });
+        for (int &u : result.second) u = csr.toExternal[u];
+        return result;
     }
 
     // Print a human-friendly summary of the graph
@@ -90,35 +1737,15 @@ public:
     // Display the adjacency matrix of distances (0 = no direct road; diagonal = 0)
     void printAdjacencyMatrix() const {
         const int n = (int)names.size();
-        // Build matrix initialised with 0s
-        vector<vector<int>> mat(n, vector<int>(n, 0));
-        // Fill from adjacency list
+        // Same contiguous n x n block as the distance table; cells without a road stay INF
+        DistanceTable direct(n);
         for (int u = 0; u < n; ++u) {
             for (auto [v, km] : adj[u]) {
-                mat[u][v] = km;
+                direct.row(u)[v] = km;
             }
         }
-
-        // Header row: codes
-        const int cellW = 9;
-        cout << "Adjacency Matrix (Distances in km):\n\n";
-        cout << padRight("", cellW);
-        for (int j = 0; j < n; ++j) {
-            cout << padRight(codes[j], cellW);
-        }
-        cout << "\n";
-
-        // Rows
-        for (int i = 0; i < n; ++i) {
-            cout << padRight(codes[i], cellW);
-            for (int j = 0; j < n; ++j) {
-                // Print 0 if no direct road (or i==j), else the distance
-                string cell = to_string(mat[i][j]);
-                cout << padRight(cell, cellW);
-            }
-            cout << "\n";
-        }
-        cout << "\n";
+        // Print 0 if no direct road (or i==j), else the distance
+        printCityTable("Adjacency Matrix (Distances in km):", direct, "0");
     }
 
     // ---------------------------- BFS Traversal --------------------------------
@@ -133,28 +1760,29 @@ public:
     */
 
     vector<int> bfsOrder(const string &startCity) const {
-        vector<int> order;                         // store the visiting order
         auto it = indexOf.find(startCity);
-        if (it == indexOf.end()) return order;    // return empty if city unknown
-        int s = it->second;
+        if (it == indexOf.end()) return {};       // return empty if city unknown
+        return bfsOrder(it->second);
+    }
 
-        vector<int> visited(names.size(), 0);
-        queue<int> q;
-        visited[s] = 1;
-        q.push(s);
+    vector<int> bfsOrder(int s) const {
+        if (!frozen) return bfsOrderOn(AdjacencyListView{&adj}, s);
+        vector<int> order = bfsOrderOn(csr, csr.toInternal[s]);
+        for (int &u : order) u = csr.toExternal[u];
+        return order;
+    }
 
-        while (!q.empty()) {
-            int u = q.front(); q.pop();
-            order.push_back(u);
-            for (auto [v, km] : adj[u]) {
-                (void)km; // distance not needed for BFS ordering
-                if (!visited[v]) {
-                    visited[v] = 1;
-                    q.push(v);
-                }
-            }
+    // Hop distances and BFS-tree parents from s (direction-optimizing, optionally multi-threaded)
+    BfsTree bfsTree(int s, int threads = 1, bool allowBottomUp = true) const {
+        if (!frozen) return directionOptimizingBfs(AdjacencyListView{&adj}, s, threads, allowBottomUp);
+        BfsTree inner = directionOptimizingBfs(csr, csr.toInternal[s], threads, allowBottomUp);
+        BfsTree tree = inner;
+        for (int i = 0; i < (int)inner.hops.size(); ++i) {
+            int city = csr.toExternal[i];
+            tree.hops[city] = inner.hops[i];
+            tree.parent[city] = inner.parent[i] < 0 ? -1 : csr.toExternal[inner.parent[i]];
         }
-        return order;
+        return tree;
     }
 
     // ------------------------- Dijkstra's Algorithm ----------------------------
@@ -166,6 +1794,8 @@ public:
       smallest temporary distance.
     - When we find a shorter path to a neighbour, we update dist[] and record
       the predecessor to reconstruct the route.
+    - Which queue is used is set by 'dijkstraQueue'; all of them give the same
+      distances, only the speed differs.
     */
 
     pair<int, vector<int>> dijkstraPath(const string &srcCity, const string &dstCity) const {
@@ -174,57 +1804,246 @@ public:
         if (itS == indexOf.end() || itT == indexOf.end()) {
             return {INT_MAX, {}}; // invalid cities
         }
-        int s = itS->second, t = itT->second;
+        return dijkstraPath(itS->second, itT->second);
+    }
+
+    pair<int, vector<int>> dijkstraPath(int s, int t, SearchStats *stats = nullptr) const {
+        return searchCurrentLayout(s, t, [&](const auto &g, int from, int to, auto cityOf) {
+            (void)cityOf;
+            return withQueue(dijkstraQueue, [&](auto tag) {
+                return dijkstraOn<typename decltype(tag)::type>(g, from, to, stats);
+            });
+        });
+    }
+
+    // Same answer as dijkstraPath, searching from both ends at once
+    pair<int, vector<int>> bidirectionalPath(int s, int t, SearchStats *stats = nullptr) const {
+        return searchCurrentLayout(s, t, [&](const auto &g, int from, int to, auto cityOf) {
+            (void)cityOf;
+            return bidirectionalDijkstraOn(g, from, to, stats);
+        });
+    }
+
+    // Same answer as dijkstraPath, guided towards t by a RouteHeuristic built for this graph
+    pair<int, vector<int>> aStarPath(int s, int t, const RouteHeuristic &heuristic, SearchStats *stats = nullptr) const {
+        return searchCurrentLayout(s, t, [&](const auto &g, int from, int to, auto cityOf) {
+            auto estimate = [&](int v) { return heuristic.estimate(cityOf(v), t); };
+            return aStarOn(g, from, to, estimate, stats);
+        });
+    }
+
+    // Dijkstra distances from s to every city (1e9 = unreachable)
+    vector<int> shortestDistances(int s) const {
+        vector<int> dist;
+        withQueue(dijkstraQueue, [&](auto tag) {
+            using Queue = typename decltype(tag)::type;
+            if (!frozen) shortestDistancesOn<Queue>(AdjacencyListView{&adj}, s, dist);
+            else shortestDistancesOn<Queue>(csr, csr.toInternal[s], dist);
+        });
+        if (!frozen) return dist;
+        vector<int> byCity(dist.size());
+        for (size_t v = 0; v < dist.size(); ++v) byCity[csr.toExternal[v]] = dist[v];
+        return byCity;
+    }
+
+    // Lower-bound tables for aStarPath: straight-line distances between city locations
+    // (every city needs one) and/or exact distances to 'landmarkCount' far-apart cities
+    RouteHeuristic buildRouteHeuristic(bool useLocations, int landmarkCount) const {
         const int n = (int)names.size();
         const int INF = 1e9;
+        RouteHeuristic h;
+        if (useLocations) {
+            h.unitPoint.resize(n);
+            for (int u = 0; u < n; ++u) {
+                if (u >= (int)locations.size() || !locations[u].known()) {
+                    throw runtime_error("city " + names[u] + " has no location for the straight-line estimate");
+                }
+                double lat = locations[u].lat * M_PI / 180.0, lon = locations[u].lon * M_PI / 180.0;
+                h.unitPoint[u] = {cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat)};
+            }
+            // Shrink the estimate if some road is shorter than the straight line between its ends
+            double scale = 1.0;
+            for (int u = 0; u < n; ++u) {
+                for (auto [v, km] : adj[u]) {
+                    double dx = h.unitPoint[u][0] - h.unitPoint[v][0];
+                    double dy = h.unitPoint[u][1] - h.unitPoint[v][1];
+                    double dz = h.unitPoint[u][2] - h.unitPoint[v][2];
+                    double line = RouteHeuristic::EARTH_RADIUS_KM * sqrt(dx * dx + dy * dy + dz * dz);
+                    if (line > 0) scale = min(scale, km / line);
+                }
+            }
+            h.kmPerChordUnit = RouteHeuristic::EARTH_RADIUS_KM * scale;
+        }
 
-        vector<int> dist(n, INF);
-        vector<int> parent(n, -1);
-        // min-heap of (distanceSoFar, node)
-        priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq;
+        // Farthest-point landmarks: each new one is the city farthest from all chosen so far
+        landmarkCount = max(0, min(landmarkCount, n));
+        h.landmarkCount = landmarkCount;
+        h.landmarkKm.assign((size_t)n * landmarkCount, INF);
+        vector<int> nearestLandmarkKm(n, INF);
+        vector<int> dist = landmarkCount > 0 ? shortestDistances(0) : vector<int>();
+        for (int i = 0; i < landmarkCount; ++i) {
+            const vector<int> &score = i == 0 ? dist : nearestLandmarkKm;
+            int next = -1;
+            for (int v = 0; v < n; ++v) {
+                bool taken = find(h.landmarks.begin(), h.landmarks.end(), v) != h.landmarks.end();
+                if (!taken && score[v] < INF && (next < 0 || score[v] > score[next])) next = v;
+            }
+            if (next < 0) next = (int)(find(nearestLandmarkKm.begin(), nearestLandmarkKm.end(), INF) - nearestLandmarkKm.begin());
+            if (next >= n) break; // fewer cities than landmarks requested
+            h.landmarks.push_back(next);
+            dist = shortestDistances(next);
+            for (int v = 0; v < n; ++v) {
+                h.landmarkKm[(size_t)v * landmarkCount + i] = dist[v];
+                nearestLandmarkKm[v] = min(nearestLandmarkKm[v], dist[v]);
+            }
+        }
+        return h;
+    }
 
-        dist[s] = 0;
-        pq.push({0, s});
+    // ----------------------- All-Pairs Shortest Distances ----------------------
+    // Shortest distance between every pair of cities, in one n x n table.
+    // 'tableFile' (optional) makes the table a memory-mapped file that openFile() can reuse.
+    DistanceTable allPairsDistances(ApspMethod method = ApspMethod::Automatic, int threads = 1,
+                                    const string &tableFile = "") const {
+        const int n = (int)names.size();
+        size_t m = 0;
+        for (const auto &edges : adj) m += edges.size();
+        if (method == ApspMethod::Automatic) {
+            // n^3 tile work vs n Dijkstras of ~E log V each (tiles are ~8x cheaper per step)
+            double floyd = (double)n * n * n / 8.0;
+            double dijkstra = (double)n * (m + n) * log2(max(n, 2)) * 4.0;
+            method = floyd <= dijkstra ? ApspMethod::FloydWarshall : ApspMethod::RepeatedDijkstra;
+        }
 
-        while (!pq.empty()) {
-            auto [d, u] = pq.top(); pq.pop();
-            if (d != dist[u]) continue; // skip stale entry
-            if (u == t) break;          // we can stop early if we reached dest
-
-            for (auto [v, w] : adj[u]) {
-                if (dist[v] > dist[u] + w) {
-                    dist[v] = dist[u] + w;
-                    parent[v] = u;
-                    pq.push({dist[v], v});
+        DistanceTable table = tableFile.empty() ? DistanceTable(n) : DistanceTable::createFile(tableFile, n);
+        if (method == ApspMethod::FloydWarshall) {
+            for (int u = 0; u < n; ++u) {
+                int *row = table.row(u);
+                row[u] = 0;
+                for (auto [v, km] : adj[u]) row[v] = min(row[v], km);
+            }
+            blockedFloydWarshall(table, threads);
+            return table;
+        }
+
+        withQueue(dijkstraQueue, [&](auto tag) {
+            using Queue = typename decltype(tag)::type;
+            parallelFor(threads, (size_t)n, 16, [&](size_t b, size_t e) {
+                vector<int> dist;
+                for (size_t s = b; s < e; ++s) {
+                    int *row = table.row((int)s);
+                    if (!frozen) {
+                        shortestDistancesOn<Queue>(AdjacencyListView{&adj}, (int)s, dist);
+                        copy(dist.begin(), dist.end(), row);
+                    } else {
+                        shortestDistancesOn<Queue>(csr, csr.toInternal[s], dist);
+                        for (int v = 0; v < n; ++v) row[v] = dist[csr.toInternal[v]];
+                    }
                 }
+            });
+        });
+        return table;
+    }
+
+    // Distances from every source to every target (row i = sources[i]); one Dijkstra tree per
+    // source, stopped once all targets are settled, with 'threads' sources searched at a time
+    DistanceMatrix distanceMatrix(const vector<int> &sources, const vector<int> &targets, int threads = 1) const {
+        const int n = (int)names.size();
+        vector<char> isTarget(n, 0);
+        size_t targetCount = 0;
+        for (const vector<int> *list : {&sources, &targets}) {
+            for (int v : *list) {
+                if (v < 0 || v >= n) throw runtime_error("city index " + to_string(v) + " is out of range");
             }
         }
+        for (int v : targets) {
+            int inner = frozen ? csr.toInternal[v] : v;
+            if (!isTarget[inner]) { isTarget[inner] = 1; ++targetCount; }
+        }
+
+        DistanceMatrix result((int)sources.size(), (int)targets.size());
+        withQueue(dijkstraQueue, [&](auto tag) {
+            using Queue = typename decltype(tag)::type;
+            parallelFor(threads, sources.size(), 4, [&](size_t b, size_t e) {
+                vector<int> dist;
+                for (size_t i = b; i < e; ++i) {
+                    int *row = result.row((int)i);
+                    if (!frozen) {
+                        distancesToTargetsOn<Queue>(AdjacencyListView{&adj}, sources[i], isTarget, targetCount, dist);
+                        for (size_t j = 0; j < targets.size(); ++j) row[j] = dist[targets[j]];
+                    } else {
+                        distancesToTargetsOn<Queue>(csr, csr.toInternal[sources[i]], isTarget, targetCount, dist);
+                        for (size_t j = 0; j < targets.size(); ++j) row[j] = dist[csr.toInternal[targets[j]]];
+                    }
+                }
+            });
+        });
+        return result;
+    }
 
-        if (dist[t] >= INF) {
-            return {INT_MAX, {}}; // no path exists
+    // Route s -> t read off a distance table: follow any road (u, v) with km + D[v][t] == D[u][t].
+    // Costs O(route length x degree) and needs no search at all. A road with km > 0 always gets
+    // strictly closer to t, so it is taken first; 0 km roads only lead to cities not yet seen,
+    // and a city with nowhere new to go is stepped back from. Every city is entered at most
+    // once, so the walk always ends (with an empty route if the table is not for this graph).
+    vector<int> routeFromTable(const DistanceTable &table, int s, int t) const {
+        if (!table.reachable(s, t)) return {};
+        vector<int> route = {s};
+        unordered_set<int> seen = {s};
+        while (!route.empty() && route.back() != t) {
+            int u = route.back(), nextCity = -1;
+            for (auto [v, km] : adj[u]) {
+                if (km + table.at(v, t) != table.at(u, t) || seen.count(v)) continue;
+                nextCity = v;
+                if (km > 0) break; // strictly closer to t
+            }
+            if (nextCity < 0) {
+                route.pop_back(); // dead end inside a patch of 0 km roads
+                continue;
+            }
+            seen.insert(nextCity);
+            route.push_back(nextCity);
         }
+        return route;
+    }
 
-        // Reconstruct path from t back to s using parent[]
-        vector<int> route;
-        for (int cur = t; cur != -1; cur = parent[cur]) {
-            route.push_back(cur);
+    // Prints the all-pairs shortest distances in the same layout as the adjacency matrix
+    void printDistanceTable(const DistanceTable &table) const {
+        printCityTable("Shortest Distance Table (km, '-' = unreachable):", table, "-");
+    }
+
+    // Prints an n x n table with the city codes as row and column headers; INF cells as 'missing'
+    void printCityTable(const string &title, const DistanceTable &table, const string &missing) const {
+        const int n = (int)names.size();
+        const int cellW = 9;
+        cout << title << "\n\n";
+        cout << padRight("", cellW);
+        for (int j = 0; j < n; ++j) {
+            cout << padRight(codes[j], cellW);
+        }
+        cout << "\n";
+        for (int i = 0; i < n; ++i) {
+            cout << padRight(codes[i], cellW);
+            for (int j = 0; j < n; ++j) {
+                cout << padRight(table.reachable(i, j) ? to_string(table.at(i, j)) : missing, cellW);
+            }
+            cout << "\n";
         }
-        reverse(route.begin(), route.end());
-        return {dist[t], route};
+        cout << "\n";
     }
 };
 
 Graph buildSampleGraph() {
     Graph G;
-    // Add at least 5 cities (we add 8 for richness)
-    int ct  = G.addCity("Cape Town",      "CT");
-    int jhb = G.addCity("Johannesburg",   "JHB");
-    int dbn = G.addCity("Durban",         "DBN");
-    int gbe = G.addCity("Gaborone",       "GBE");
-    int wdh = G.addCity("Windhoek",       "WDH");
-    int hre = G.addCity("Harare",         "HRE");
-    int mpt = G.addCity("Maputo",         "MPT");
-    int bfn = G.addCity("Bloemfontein",   "BFN");
+    // Add at least 5 cities (we add 8 for richness), with approximate lat/lon for A*
+    int ct  = G.addCity("Cape Town",      "CT",  {-33.92, 18.42});
+    int jhb = G.addCity("Johannesburg",   "JHB", {-26.20, 28.05});
+    int dbn = G.addCity("Durban",         "DBN", {-29.86, 31.02});
+    int gbe = G.addCity("Gaborone",       "GBE", {-24.65, 25.91});
+    int wdh = G.addCity("Windhoek",       "WDH", {-22.56, 17.08});
+    int hre = G.addCity("Harare",         "HRE", {-17.83, 31.05});
+    int mpt = G.addCity("Maputo",         "MPT", {-25.97, 32.57});
+    int bfn = G.addCity("Bloemfontein",   "BFN", {-29.12, 26.21});
 
     (void)ct; (void)jhb; (void)dbn; (void)gbe; (void)wdh; (void)hre; (void)mpt; (void)bfn;
 
@@ -244,6 +2063,375 @@ Graph buildSampleGraph() {
     return G;
 }
 
+// ---------------------------------- Bulk Import ---------------------------------
+/*
+Loading big road datasets (XAI):
+- Input is an edge list, one road per record, either
+  CSV:    "from,to,km" or "fromName,fromCode,toName,toCode,km" (optional header line,
+          no quoted fields), or
+  binary: "EDGE", uint32 cities, uint32 roads, then per city (uint16 length + bytes) for
+          the name and the code, then per road three uint32: from, to, km.
+- The file is memory-mapped and parsed in place. Each city name is looked up ONCE per
+  appearance with a single hash probe that also inserts new names ("interning"); the road
+  is then stored as two integers, so building the graph never touches strings again.
+- The adjacency is built in two passes: count every city's degree, then reserve exactly
+  that much and fill. No vector ever grows and re-copies.
+- writeGraphImage() stores the finished graph (CSR arrays, names, codes and a name index)
+  in one file. GraphImage maps that file and works as a graph view straight away: nothing
+  is parsed or allocated, so a later run can answer its first query within milliseconds.
+*/
+struct EdgeList {
+    vector<string> names;            // city index -> name
+    vector<string> codes;            // city index -> code
+    unordered_map<string, int> indexOf;
+    vector<int> from, to, km;        // one entry per road
+};
+
+// Returns the city index for 'name', adding the city if it is new (one hash probe)
+static int internCity(EdgeList &edges, string &key, string_view name, string_view code) {
+    key.assign(name.data(), name.size());
+    auto [it, added] = edges.indexOf.try_emplace(key, (int)edges.names.size());
+    if (added) {
+        edges.names.push_back(key);
+        edges.codes.emplace_back(code.empty() ? name : code);
+    }
+    return it->second;
+}
+
+static bool parseKm(string_view text, int &km) {
+    while (!text.empty() && isspace((unsigned char)text.back())) text.remove_suffix(1);
+    auto [end, error] = from_chars(text.data(), text.data() + text.size(), km);
+    return error == errc() && end == text.data() + text.size() && km >= 0;
+}
+
+EdgeList loadEdgeListCsv(const string &path) {
+    MappedFile file = MappedFile::openReadOnly(path);
+    const char *p = file.data(), *end = p + file.size();
+    EdgeList edges;
+    size_t estimatedRoads = file.size() / 20;
+    edges.from.reserve(estimatedRoads);
+    edges.to.reserve(estimatedRoads);
+    edges.km.reserve(estimatedRoads);
+    edges.indexOf.reserve(estimatedRoads / 2);
+
+    string key;
+    vector<string_view> fields;
+    for (size_t line = 1; p < end; ++line) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        string_view text(p, eol - p);
+        p = eol + 1;
+        if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+        if (text.empty()) continue;
+
+        fields.clear();
+        for (size_t start = 0;;) {
+            size_t comma = text.find(',', start);
+            fields.push_back(text.substr(start, comma == string_view::npos ? string_view::npos : comma - start));
+            if (comma == string_view::npos) break;
+            start = comma + 1;
+        }
+        int km;
+        if ((fields.size() != 3 && fields.size() != 5) || !parseKm(fields.back(), km)) {
+            if (line == 1) continue; // header
+            throw runtime_error(path + ":" + to_string(line) + ": expected from,to,km or fromName,fromCode,toName,toCode,km");
+        }
+        bool withCodes = fields.size() == 5;
+        int u = internCity(edges, key, fields[0], withCodes ? fields[1] : string_view());
+        int v = internCity(edges, key, fields[withCodes ? 2 : 1], withCodes ? fields[3] : string_view());
+        edges.from.push_back(u);
+        edges.to.push_back(v);
+        edges.km.push_back(km);
+    }
+    return edges;
+}
+
+EdgeList loadEdgeListBinary(const string &path) {
+    MappedFile file = MappedFile::openReadOnly(path);
+    const char *p = file.data(), *end = p + file.size();
+    auto need = [&](size_t bytes) {
+        if ((size_t)(end - p) < bytes) throw runtime_error(path + " is truncated");
+    };
+    auto readU32 = [&]() { need(4); uint32_t x; memcpy(&x, p, 4); p += 4; return x; };
+    auto readText = [&]() {
+        need(2);
+        uint16_t length; memcpy(&length, p, 2); p += 2;
+        need(length);
+        string_view text(p, length);
+        p += length;
+        return text;
+    };
+
+    need(4);
+    if (memcmp(p, "EDGE", 4) != 0) throw runtime_error(path + " is not a binary edge list");
+    p += 4;
+    uint32_t cities = readU32(), roads = readU32();
+    need((size_t)cities * 4); // two 2-byte lengths per city at least, before trusting the count
+
+    EdgeList edges;
+    edges.names.reserve(cities);
+    edges.codes.reserve(cities);
+    edges.indexOf.reserve(cities);
+    string key;
+    for (uint32_t i = 0; i < cities; ++i) {
+        string_view name = readText(), code = readText();
+        if (internCity(edges, key, name, code) != (int)i) throw runtime_error(path + ": duplicate city " + key);
+    }
+    need((size_t)roads * 12);
+    edges.from.resize(roads);
+    edges.to.resize(roads);
+    edges.km.resize(roads);
+    for (uint32_t r = 0; r < roads; ++r) {
+        uint32_t u = readU32(), v = readU32(), km = readU32();
+        if (u >= cities || v >= cities || km > (uint32_t)INT_MAX) throw runtime_error(path + ": bad road " + to_string(r));
+        edges.from[r] = (int)u;
+        edges.to[r] = (int)v;
+        edges.km[r] = (int)km;
+    }
+    return edges;
+}
+
+// Picks the loader from the file's first bytes
+EdgeList loadEdgeList(const string &path) {
+    char magic[4] = {};
+    ifstream in(path, ios::binary);
+    if (!in) throw runtime_error("cannot open " + path);
+    in.read(magic, 4);
+    return memcmp(magic, "EDGE", 4) == 0 ? loadEdgeListBinary(path) : loadEdgeListCsv(path);
+}
+
+// Two-pass build: exact degrees first, then one allocation per city and a fill pass
+Graph buildGraphFromEdges(EdgeList edges) {
+    const int n = (int)edges.names.size();
+    vector<int> degree(n, 0);
+    for (size_t r = 0; r < edges.km.size(); ++r) {
+        ++degree[edges.from[r]];
+        ++degree[edges.to[r]];
+    }
+    Graph G;
+    G.names = move(edges.names);
+    G.codes = move(edges.codes);
+    G.indexOf = move(edges.indexOf);
+    G.locations.assign(n, GeoPoint());
+    G.adj.resize(n);
+    for (int u = 0; u < n; ++u) G.adj[u].reserve(degree[u]);
+    for (size_t r = 0; r < edges.km.size(); ++r) {
+        G.adj[edges.from[r]].push_back({edges.to[r], edges.km[r]});
+        G.adj[edges.to[r]].push_back({edges.from[r], edges.km[r]});
+    }
+    return G;
+}
+
+// Each road once (u < v; parallel roads kept, self-loops dropped), as CSV or binary edge list
+void writeEdgeList(const string &path, const Graph &G, bool binary) {
+    ofstream out(path, ios::binary);
+    if (!out) throw runtime_error("cannot create " + path);
+    const int n = (int)G.names.size();
+    if (!binary) {
+        string buffer;
+        for (int u = 0; u < n; ++u) {
+            for (auto [v, km] : G.adj[u]) {
+                if (u >= v) continue;
+                buffer += G.names[u]; buffer += ','; buffer += G.codes[u]; buffer += ',';
+                buffer += G.names[v]; buffer += ','; buffer += G.codes[v]; buffer += ',';
+                buffer += to_string(km); buffer += '\n';
+                if (buffer.size() > (1 << 20)) { out << buffer; buffer.clear(); }
+            }
+        }
+        out << buffer;
+    } else {
+        auto writeU32 = [&](uint32_t x) { out.write(reinterpret_cast<const char *>(&x), 4); };
+        auto writeText = [&](const string &text) {
+            if (text.size() > UINT16_MAX) throw runtime_error("city name too long: " + text.substr(0, 40));
+            uint16_t length = (uint16_t)text.size();
+            out.write(reinterpret_cast<const char *>(&length), 2);
+            out.write(text.data(), length);
+        };
+        uint32_t roads = 0;
+        for (int u = 0; u < n; ++u) {
+            for (auto [v, km] : G.adj[u]) { (void)km; roads += u < v; }
+        }
+        out.write("EDGE", 4);
+        writeU32((uint32_t)n);
+        writeU32(roads);
+        for (int u = 0; u < n; ++u) { writeText(G.names[u]); writeText(G.codes[u]); }
+        vector<uint32_t> block;
+        for (int u = 0; u < n; ++u) {
+            for (auto [v, km] : G.adj[u]) {
+                if (u >= v) continue;
+                block.insert(block.end(), {(uint32_t)u, (uint32_t)v, (uint32_t)km});
+            }
+        }
+        out.write(reinterpret_cast<const char *>(block.data()), block.size() * sizeof(uint32_t));
+    }
+    if (!out) throw runtime_error("write failed: " + path);
+}
+
+/*
+Graph image layout (native byte order, every section starts on an 8-byte boundary):
+  header   "GRPH", uint32 version (1), int32 n, int32 0, int64 m, int64 nameBytes, int64 codeBytes
+  int32    offsets[n + 1], targets[m], weights[m]       (CSR, original city numbering)
+  int64    nameStart[n + 1], then the name characters
+  int64    codeStart[n + 1], then the code characters
+  int32    byName[n]                                    (city indices sorted by name)
+*/
+class GraphImage {
+public:
+    static GraphImage open(const string &path) {
+        GraphImage g;
+        g.file = MappedFile::openReadOnly(path);
+        const char *base = g.file.data();
+        auto fail = [&]() { throw runtime_error(path + " is not a graph image"); };
+        if (g.file.size() < HEADER_BYTES || memcmp(base, "GRPH", 4) != 0) fail();
+        uint32_t version; int32_t n; int64_t m, nameBytes, codeBytes;
+        memcpy(&version, base + 4, 4);
+        memcpy(&n, base + 8, 4);
+        memcpy(&m, base + 16, 8);
+        memcpy(&nameBytes, base + 24, 8);
+        memcpy(&codeBytes, base + 32, 8);
+        if (version != 1 || n < 0 || m < 0 || nameBytes < 0 || codeBytes < 0 ||
+            g.file.size() != imageBytes(n, m, nameBytes, codeBytes)) fail();
+
+        size_t at = HEADER_BYTES;
+        auto take = [&](size_t bytes) { const char *p = base + at; at = align8(at + bytes); return p; };
+        g.n = n;
+        g.offsets = reinterpret_cast<const int32_t *>(take((n + 1) * 4));
+        g.targets = reinterpret_cast<const int32_t *>(take(m * 4));
+        g.weights = reinterpret_cast<const int32_t *>(take(m * 4));
+        g.nameStart = reinterpret_cast<const int64_t *>(take((n + 1) * 8));
+        g.nameChars = take(nameBytes);
+        g.codeStart = reinterpret_cast<const int64_t *>(take((n + 1) * 8));
+        g.codeChars = take(codeBytes);
+        g.byName = reinterpret_cast<const int32_t *>(take(n * 4));
+
+        // Every index the queries follow must stay inside the mapping
+        if (g.offsets[0] != 0 || g.offsets[n] != m) fail();
+        for (int u = 0; u < n; ++u) {
+            if (g.offsets[u + 1] < g.offsets[u]) fail();
+        }
+        for (int64_t e = 0; e < m; ++e) {
+            if (g.targets[e] < 0 || g.targets[e] >= n || g.weights[e] < 0) fail();
+        }
+        for (auto [start, bytes] : {pair<const int64_t *, int64_t>{g.nameStart, nameBytes}, {g.codeStart, codeBytes}}) {
+            if (start[0] != 0 || start[n] != bytes) fail();
+            for (int u = 0; u < n; ++u) {
+                if (start[u + 1] < start[u]) fail();
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            if (g.byName[i] < 0 || g.byName[i] >= n) fail();
+        }
+        return g;
+    }
+
+    int vertexCount() const { return n; }
+    int degree(int u) const { return offsets[u + 1] - offsets[u]; }
+    size_t edgeCount() const { return (size_t)offsets[n]; }
+
+    template <class F>
+    void forEachEdge(int u, F &&f) const {
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) f(targets[e], weights[e]);
+    }
+
+    template <class F>
+    bool forEachEdgeUntil(int u, F &&f) const {
+        for (int e = offsets[u]; e < offsets[u + 1]; ++e) {
+            if (f(targets[e], weights[e])) return true;
+        }
+        return false;
+    }
+
+    string_view name(int u) const { return string_view(nameChars + nameStart[u], nameStart[u + 1] - nameStart[u]); }
+    string_view code(int u) const { return string_view(codeChars + codeStart[u], codeStart[u + 1] - codeStart[u]); }
+
+    // City index by exact name (binary search over the stored name order), -1 if unknown
+    int find(string_view cityName) const {
+        const int32_t *it = lower_bound(byName, byName + n, cityName,
+                                        [&](int32_t u, string_view key) { return name(u) < key; });
+        return it != byName + n && name(*it) == cityName ? *it : -1;
+    }
+
+    // Mutable copy for code that needs a full Graph
+    Graph toGraph() const {
+        Graph G;
+        G.names.reserve(n);
+        G.codes.reserve(n);
+        G.indexOf.reserve(n);
+        G.locations.assign(n, GeoPoint());
+        G.adj.resize(n);
+        for (int u = 0; u < n; ++u) {
+            G.names.emplace_back(name(u));
+            G.codes.emplace_back(code(u));
+            G.indexOf.emplace(G.names.back(), u);
+            G.adj[u].reserve(degree(u));
+            forEachEdge(u, [&](int v, int km) { G.adj[u].push_back({v, km}); });
+        }
+        return G;
+    }
+
+    static size_t align8(size_t x) { return (x + 7) & ~size_t(7); }
+    static size_t imageBytes(int64_t n, int64_t m, int64_t nameBytes, int64_t codeBytes) {
+        size_t at = HEADER_BYTES;
+        for (size_t bytes : {size_t((n + 1) * 4), size_t(m * 4), size_t(m * 4), size_t((n + 1) * 8),
+                             size_t(nameBytes), size_t((n + 1) * 8), size_t(codeBytes), size_t(n * 4)}) {
+            at = align8(at + bytes);
+        }
+        return at;
+    }
+    static constexpr size_t HEADER_BYTES = 40;
+
+private:
+    MappedFile file;
+    int n = 0;
+    const int32_t *offsets = nullptr, *targets = nullptr, *weights = nullptr, *byName = nullptr;
+    const int64_t *nameStart = nullptr, *codeStart = nullptr;
+    const char *nameChars = nullptr, *codeChars = nullptr;
+};
+
+void writeGraphImage(const string &path, const Graph &G) {
+    const int n = (int)G.names.size();
+    CsrGraph csr = CsrGraph::build(G.adj, false);
+    const int64_t m = (int64_t)csr.edgeCount();
+    if (m > INT32_MAX) throw runtime_error("graph too large for image format");
+    int64_t nameBytes = 0, codeBytes = 0;
+    for (int u = 0; u < n; ++u) { nameBytes += G.names[u].size(); codeBytes += G.codes[u].size(); }
+
+    MappedFile file = MappedFile::create(path, GraphImage::imageBytes(n, m, nameBytes, codeBytes));
+    char *base = file.data();
+    uint32_t version = 1;
+    int32_t count = n, zero = 0;
+    memcpy(base, "GRPH", 4);
+    memcpy(base + 4, &version, 4);
+    memcpy(base + 8, &count, 4);
+    memcpy(base + 12, &zero, 4);
+    memcpy(base + 16, &m, 8);
+    memcpy(base + 24, &nameBytes, 8);
+    memcpy(base + 32, &codeBytes, 8);
+
+    size_t at = GraphImage::HEADER_BYTES;
+    auto put = [&](const void *data, size_t bytes) {
+        if (bytes) memcpy(base + at, data, bytes);
+        at = GraphImage::align8(at + bytes);
+    };
+    put(csr.offsets.data(), (n + 1) * 4);
+    put(csr.targets.data(), m * 4);
+    put(csr.weights.data(), m * 4);
+    for (const vector<string> *texts : {&G.names, &G.codes}) {
+        vector<int64_t> start(n + 1, 0);
+        string chars;
+        for (int u = 0; u < n; ++u) {
+            chars += (*texts)[u];
+            start[u + 1] = (int64_t)chars.size();
+        }
+        put(start.data(), (n + 1) * 8);
+        put(chars.data(), chars.size());
+    }
+    vector<int32_t> byName(n);
+    iota(byName.begin(), byName.end(), 0);
+    sort(byName.begin(), byName.end(), [&](int a, int b) { return G.names[a] < G.names[b]; });
+    put(byName.data(), n * 4);
+}
+
 // ------------------------------- Menu Helpers ----------------------------------
 
 // Get a valid city name from user input; we accept either code or full name.
@@ -285,12 +2473,852 @@ void printRoute(const Graph &G, const vector<int> &route) {
     cout << "\n";
 }
 
+// --------------------------- Synthetic Road Graphs -----------------------------
+/*
+Large test graphs (XAI):
+- A side x side grid of towns ("V0", "V1", ...) in southern Africa, up to 20 km apart (closer
+  for big grids, so the whole map stays about 2000 km wide), each nudged a little off the
+  grid. Each town has a road to its right and lower neighbour with 95% probability; a road
+  is 1.0–1.4x the straight-line distance, like a real winding road.
+- The towns are added in random order, like rows coming from an unsorted data file, so
+  neighbouring towns usually do NOT have neighbouring indices. This is the case where the
+  storage layout (adjacency list vs CSR vs renumbered CSR) matters.
+- longRoadFraction adds that many (x towns) extra roads between random towns, 1.0–1.3x
+  the straight line. A few of these turn the grid into a "small world" with a low hop
+  diameter.
+*/
+Graph buildSyntheticRoadGraph(int vertices, unsigned seed, double longRoadFraction = 0.0) {
+    mt19937 rng(seed);
+    const int side = max(1, (int)ceil(sqrt((double)vertices)));
+    const int n = side * side;
+    const double spacingKm = min(20.0, 2000.0 / side);
+    const double kmPerDegree = 111.2;
+
+    vector<int> idOf(n); // grid cell -> city index
+    iota(idOf.begin(), idOf.end(), 0);
+    shuffle(idOf.begin(), idOf.end(), rng);
+    vector<int> cellOf(n);
+    for (int cell = 0; cell < n; ++cell) cellOf[idOf[cell]] = cell;
+
+    Graph G;
+    G.names.reserve(n);
+    G.codes.reserve(n);
+    G.locations.reserve(n);
+    G.indexOf.reserve(n);
+    uniform_real_distribution<double> jitter(-0.25, 0.25);
+    for (int i = 0; i < n; ++i) {
+        string name = "V" + to_string(i);
+        int r = cellOf[i] / side, c = cellOf[i] % side;
+        double lat = -34.0 + (r + jitter(rng)) * spacingKm / kmPerDegree;
+        double lon = 18.0 + (c + jitter(rng)) * spacingKm / (kmPerDegree * cos(lat * M_PI / 180.0));
+        G.addCity(name, name, {lat, lon});
+    }
+
+    uniform_real_distribution<double> winding(1.0, 1.4), straighter(1.0, 1.3);
+    uniform_int_distribution<int> percent(0, 99);
+    auto road = [&](int u, int v, double factor) {
+        int w = max(1, (int)ceil(straightLineKm(G.locations[u], G.locations[v]) * factor));
+        G.adj[u].push_back({v, w});
+        G.adj[v].push_back({u, w});
+    };
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int cell = r * side + c;
+            if (c + 1 < side && percent(rng) < 95) road(idOf[cell], idOf[cell + 1], winding(rng));
+            if (r + 1 < side && percent(rng) < 95) road(idOf[cell], idOf[cell + side], winding(rng));
+        }
+    }
+    uniform_int_distribution<int> anyCell(0, n - 1);
+    for (long long k = (long long)(longRoadFraction * n); k > 0; --k) {
+        int u = idOf[anyCell(rng)], v = idOf[anyCell(rng)];
+        if (u == v) continue;
+        road(u, v, straighter(rng));
+    }
+    return G;
+}
+
+// Small random graph with 0-5 km roads (parallel roads allowed). Zero-length roads are valid
+// input and the awkward case for shortcuts and route walks, so the benchmarks check them too.
+Graph buildZeroKmTestGraph(int vertices, unsigned seed) {
+    mt19937 rng(seed);
+    Graph G(vertices);
+    for (int i = 0; i < vertices; ++i) G.addCity("Z" + to_string(i), "Z" + to_string(i));
+    uniform_int_distribution<int> anyCity(0, vertices - 1), km(0, 5);
+    for (int k = 0; k < 2 * vertices; ++k) {
+        int u = anyCity(rng), v = anyCity(rng);
+        if (u != v) G.addUndirectedRoad(u, v, km(rng));
+    }
+    return G;
+}
+
+// ------------------------------- Benchmarks -----------------------------------
+/*
+Benchmark mode (XAI):
+- "--bench-csr N [queries] [seed]" builds a synthetic graph with about N towns and times the
+  same BFS and Dijkstra queries on the adjacency list, on a CSR copy, and on a CSR copy
+  renumbered in BFS order. Results are checked against the adjacency list run.
+- "--bench-bfs N [threads] [queries] [seed]" compares the queue BFS with the
+  direction-optimizing BFS (top-down only, switching, and switching with threads) on a plain
+  grid and on a low-diameter grid with long roads, validating every BFS tree.
+- "--bench-apsp N [threads] [table-file]" builds the all-pairs table with plain
+  Floyd–Warshall, blocked Floyd–Warshall and repeated Dijkstra, checks they agree, and
+  compares a table lookup with a dijkstraPath call. With a file, the table is also written
+  as a memory-mapped file and mapped again to time reopening. Routes read off the table are
+  also checked on small random graphs with 0 km roads.
+- "--bench-import N [dir]" writes a synthetic graph as CSV and binary edge lists and times
+  loading it line by line through addCity/addUndirectedRoad, with the bulk loaders, and by
+  mapping a graph image.
+- "--bench-p2p N [queries] [landmarks] [seed]" times random single-route queries with
+  dijkstraPath, bidirectional Dijkstra and A* (straight line, landmarks, both) and reports
+  the cities settled per query; all answers are checked against dijkstraPath.
+- "--bench-ch N [threads] [queries] [file]" builds a contraction hierarchy, saves and reloads
+  it, and checks random routes (km, route length, endpoints) against dijkstraPath while
+  timing both. It also checks every pair on small random graphs with 0 km roads.
+- "--bench-batch N [depots] [drop-points] [threads]" fills a depots x drop-points distance
+  matrix with one Dijkstra tree per depot and with the hierarchy's buckets, checks both
+  against dijkstraPath (also on graphs with 0 km roads) and estimates the per-cell cost.
+- Without arguments the program runs the normal interactive menu.
+*/
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static size_t adjacencyListBytes(const Graph &G) {
+    size_t bytes = G.adj.capacity() * sizeof(G.adj[0]);
+    for (const auto &edges : G.adj) bytes += edges.capacity() * sizeof(edges[0]);
+    return bytes;
+}
+
+int benchCsr(int vertices, int queries, unsigned seed) {
+    auto t0 = chrono::steady_clock::now();
+    Graph G = buildSyntheticRoadGraph(vertices, seed);
+    const int n = (int)G.names.size();
+    size_t m = 0;
+    for (const auto &edges : G.adj) m += edges.size();
+    cout << "Synthetic graph: " << n << " towns, " << m / 2 << " roads (built in "
+         << formatFixed(secondsSince(t0), 3) << " s)\n";
+
+    mt19937 rng(seed + 1);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<pair<int,int>> pairs(queries);
+    for (auto &[s, t] : pairs) { s = pick(rng); t = pick(rng); }
+
+    // Reference answers from the adjacency list
+    vector<size_t> reachable(queries);
+    vector<int> bestKm(queries);
+
+    cout << padRight("Layout", 18) << padRight("Build s", 10) << padRight("MiB", 10)
+         << padRight("BFS ms", 12) << padRight("Dijkstra ms", 14) << "Check\n";
+
+    const char *layouts[] = {"adjacency-list", "csr", "csr-renumbered"};
+    for (int layout = 0; layout < 3; ++layout) {
+        auto tb = chrono::steady_clock::now();
+        if (layout == 0) G.unfreeze();
+        else G.freeze(layout == 2);
+        double buildS = secondsSince(tb);
+        double mib = (layout == 0 ? adjacencyListBytes(G) : G.csr.memoryBytes()) / 1048576.0;
+
+        bool ok = true;
+        auto tq = chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            size_t count = G.bfsOrder(pairs[q].first).size();
+            if (layout == 0) reachable[q] = count;
+            else ok = ok && count == reachable[q];
+        }
+        double bfsMs = secondsSince(tq) * 1000.0 / max(1, queries);
+
+        tq = chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            auto [km, route] = G.dijkstraPath(pairs[q].first, pairs[q].second);
+            if (layout == 0) bestKm[q] = km;
+            else ok = ok && km == bestKm[q];
+        }
+        double dijkstraMs = secondsSince(tq) * 1000.0 / max(1, queries);
+
+        cout << padRight(layouts[layout], 18) << padRight(formatFixed(buildS, 3), 10)
+             << padRight(formatFixed(mib, 1), 10) << padRight(formatFixed(bfsMs, 2), 12)
+             << padRight(formatFixed(dijkstraMs, 2), 14) << (ok ? "ok" : "MISMATCH") << "\n";
+        if (!ok) return 1;
+    }
+    return 0;
+}
+
+// Checks hops/parents form a valid BFS tree: parents are neighbours one hop closer, and
+// no road joins vertices whose hop counts differ by more than one
+static bool isValidBfsTree(const Graph &G, int s, const BfsTree &tree, size_t expectedReached) {
+    const int n = (int)G.adj.size();
+    if (tree.hops[s] != 0 || tree.parent[s] != s) return false;
+    size_t reached = 0;
+    for (int v = 0; v < n; ++v) {
+        if (tree.hops[v] < 0) {
+            if (tree.parent[v] != -1) return false;
+            continue;
+        }
+        ++reached;
+        for (auto [u, km] : G.adj[v]) {
+            (void)km;
+            if (tree.hops[u] < 0 || abs(tree.hops[u] - tree.hops[v]) > 1) return false;
+        }
+        if (v == s) continue;
+        int p = tree.parent[v];
+        if (p < 0 || tree.hops[p] != tree.hops[v] - 1) return false;
+        bool isNeighbour = false;
+        for (auto [u, km] : G.adj[v]) { (void)km; isNeighbour = isNeighbour || u == p; }
+        if (!isNeighbour) return false;
+    }
+    return reached == expectedReached;
+}
+
+int benchBfs(int vertices, int threads, int queries, unsigned seed) {
+    cout << padRight("Graph", 14) << padRight("Method", 26) << padRight("BFS ms", 10)
+         << padRight("Levels", 8) << padRight("Bottom-up", 11) << "Check\n";
+
+    const double longRoads[] = {0.0, 0.02};
+    for (double fraction : longRoads) {
+        Graph G = buildSyntheticRoadGraph(vertices, seed, fraction);
+        G.freeze(true);
+        const int n = (int)G.names.size();
+        mt19937 rng(seed + 2);
+        uniform_int_distribution<int> pick(0, n - 1);
+        vector<int> starts(queries);
+        for (int &s : starts) s = pick(rng);
+        string graphName = fraction > 0 ? "small-world" : "grid";
+
+        vector<size_t> reached(queries);
+        auto tq = chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) reached[q] = G.bfsOrder(starts[q]).size();
+        cout << padRight(graphName, 14) << padRight("queue (bfsOrder)", 26)
+             << padRight(formatFixed(secondsSince(tq) * 1000.0 / max(1, queries), 2), 10) << "\n";
+
+        struct Method { string name; int threads; bool bottomUp; };
+        vector<Method> methods = {{"top-down only", 1, false},
+                                  {"direction-optimizing", 1, true},
+                                  {"direction-optimizing x" + to_string(threads), threads, true}};
+        for (const auto &method : methods) {
+            bool ok = true;
+            BfsTree tree;
+            double totalS = 0;
+            for (int q = 0; q < queries; ++q) {
+                tq = chrono::steady_clock::now();
+                tree = G.bfsTree(starts[q], method.threads, method.bottomUp);
+                totalS += secondsSince(tq);
+                ok = ok && isValidBfsTree(G, starts[q], tree, reached[q]);
+            }
+            cout << padRight(graphName, 14) << padRight(method.name, 26)
+                 << padRight(formatFixed(totalS * 1000.0 / max(1, queries), 2), 10)
+                 << padRight(to_string(tree.levels), 8) << padRight(to_string(tree.bottomUpLevels), 11)
+                 << (ok ? "ok" : "INVALID") << "\n";
+            if (!ok) return 1;
+        }
+    }
+    return 0;
+}
+
+static bool sameTables(const DistanceTable &a, const DistanceTable &b) {
+    if (a.size() != b.size()) return false;
+    for (int u = 0; u < a.size(); ++u) {
+        if (!equal(a.row(u), a.row(u) + a.size(), b.row(u))) return false;
+    }
+    return true;
+}
+
+int benchApsp(int vertices, int threads, const string &tableFile) {
+    Graph G = buildSyntheticRoadGraph(vertices, 42);
+    G.freeze(true);
+    const int n = (int)G.names.size();
+    cout << "Synthetic graph: " << n << " towns, table " << formatFixed((double)n * n * 4 / 1048576.0, 1) << " MiB\n";
+    cout << padRight("Method", 26) << padRight("Seconds", 10) << "Check\n";
+
+    // Reference: textbook triple loop on the same contiguous table
+    auto t0 = chrono::steady_clock::now();
+    DistanceTable reference(n);
+    for (int u = 0; u < n; ++u) {
+        reference.row(u)[u] = 0;
+        for (auto [v, km] : G.adj[u]) reference.row(u)[v] = min(reference.row(u)[v], km);
+    }
+    for (int k = 0; k < n; ++k) {
+        for (int i = 0; i < n; ++i) {
+            int dik = reference.at(i, k);
+            if (dik >= DistanceTable::INF) continue;
+            int *rowI = reference.row(i);
+            const int *rowK = reference.row(k);
+            for (int j = 0; j < n; ++j) rowI[j] = min(rowI[j], dik + rowK[j]);
+        }
+    }
+    cout << padRight("floyd-warshall (plain)", 26) << padRight(formatFixed(secondsSince(t0), 3), 10) << "reference\n";
+
+    struct Run { string name; ApspMethod method; int threads; };
+    vector<Run> runs = {{"floyd-warshall (blocked)", ApspMethod::FloydWarshall, 1},
+                        {"floyd-warshall x" + to_string(threads), ApspMethod::FloydWarshall, threads},
+                        {"repeated dijkstra", ApspMethod::RepeatedDijkstra, 1},
+                        {"repeated dijkstra x" + to_string(threads), ApspMethod::RepeatedDijkstra, threads}};
+    for (const auto &run : runs) {
+        t0 = chrono::steady_clock::now();
+        DistanceTable table = G.allPairsDistances(run.method, run.threads);
+        double seconds = secondsSince(t0);
+        bool ok = sameTables(table, reference);
+        cout << padRight(run.name, 26) << padRight(formatFixed(seconds, 3), 10) << (ok ? "ok" : "MISMATCH") << "\n";
+        if (!ok) return 1;
+    }
+
+    if (!tableFile.empty()) {
+        t0 = chrono::steady_clock::now();
+        { DistanceTable written = G.allPairsDistances(ApspMethod::Automatic, threads, tableFile); }
+        double writeS = secondsSince(t0);
+        t0 = chrono::steady_clock::now();
+        DistanceTable mapped = DistanceTable::openFile(tableFile);
+        double openS = secondsSince(t0);
+        bool ok = sameTables(mapped, reference);
+        cout << padRight("write mapped file", 26) << padRight(formatFixed(writeS, 3), 10) << "\n";
+        cout << padRight("reopen mapped file", 26) << padRight(formatFixed(openS, 6), 10) << (ok ? "ok" : "MISMATCH") << "\n";
+        if (!ok) return 1;
+    }
+
+    // Per-query cost: table lookup + route walk vs a fresh Dijkstra
+    mt19937 rng(7);
+    uniform_int_distribution<int> pick(0, n - 1);
+    const int queries = 200;
+    vector<pair<int,int>> pairs(queries);
+    for (auto &[s, t] : pairs) { s = pick(rng); t = pick(rng); }
+    long long checksum = 0;
+    t0 = chrono::steady_clock::now();
+    for (auto [s, t] : pairs) checksum += G.dijkstraPath(s, t).first;
+    double dijkstraUs = secondsSince(t0) * 1e6 / queries;
+    t0 = chrono::steady_clock::now();
+    for (auto [s, t] : pairs) checksum -= reference.reachable(s, t) ? reference.at(s, t) : INT_MAX;
+    double lookupUs = secondsSince(t0) * 1e6 / queries;
+    t0 = chrono::steady_clock::now();
+    size_t hops = 0;
+    for (auto [s, t] : pairs) hops += G.routeFromTable(reference, s, t).size();
+    double routeUs = secondsSince(t0) * 1e6 / queries;
+    cout << "Per query: dijkstraPath " << formatFixed(dijkstraUs, 2) << " us, table lookup "
+         << formatFixed(lookupUs, 3) << " us, route from table " << formatFixed(routeUs, 2) << " us ("
+         << hops / queries << " cities)" << (checksum == 0 ? "" : "  MISMATCH") << "\n";
+
+    // Zero-km roads: the table walk must still end at t with a route of the table's length
+    int zeroWrong = 0;
+    for (int g = 0; g < 50; ++g) {
+        Graph Z = buildZeroKmTestGraph(40, 3000 + g);
+        DistanceTable table = Z.allPairsDistances();
+        for (int s = 0; s < 40; ++s) {
+            for (int t = 0; t < 40; ++t) {
+                vector<int> route = Z.routeFromTable(table, s, t);
+                long long length = 0;
+                for (size_t i = 0; i + 1 < route.size(); ++i) {
+                    int best = INT_MAX;
+                    for (auto [v, km] : Z.adj[route[i]]) if (v == route[i + 1]) best = min(best, km);
+                    length += best;
+                }
+                bool ok = table.reachable(s, t) ? !route.empty() && route.front() == s && route.back() == t &&
+                                                      length == table.at(s, t)
+                                                : route.empty();
+                zeroWrong += !ok;
+            }
+        }
+    }
+    cout << "Zero-km roads (50 graphs x 40 towns, route from table): "
+         << (zeroWrong == 0 ? string("ok") : to_string(zeroWrong) + " MISMATCHES") << "\n";
+    return checksum == 0 && zeroWrong == 0 ? 0 : 1;
+}
+
+// Baseline loader: getline + stringstream, one addCity/addUndirectedRoad per line
+static Graph loadCsvLineByLine(const string &path) {
+    ifstream in(path);
+    if (!in) throw runtime_error("cannot open " + path);
+    Graph G;
+    string line;
+    while (getline(in, line)) {
+        stringstream fields(line);
+        string fromName, fromCode, toName, toCode, km;
+        getline(fields, fromName, ',');
+        getline(fields, fromCode, ',');
+        getline(fields, toName, ',');
+        getline(fields, toCode, ',');
+        getline(fields, km);
+        if (!G.indexOf.count(fromName)) G.addCity(fromName, fromCode);
+        if (!G.indexOf.count(toName)) G.addCity(toName, toCode);
+        G.addUndirectedRoad(fromName, toName, stoi(km));
+    }
+    return G;
+}
+
+// Same cities (by name) with the same multiset of roads. CSV edge lists cannot hold cities
+// without roads, so 'ignoreIsolated' skips those.
+static bool sameGraph(const Graph &a, const Graph &b, bool ignoreIsolated = false) {
+    auto connected = [&](const Graph &g) {
+        size_t count = 0;
+        for (const auto &edges : g.adj) count += !ignoreIsolated || !edges.empty();
+        return count;
+    };
+    if (connected(a) != connected(b)) return false;
+    for (size_t u = 0; u < a.names.size(); ++u) {
+        if (ignoreIsolated && a.adj[u].empty()) continue;
+        auto it = b.indexOf.find(a.names[u]);
+        if (it == b.indexOf.end() || b.codes[it->second] != a.codes[u]) return false;
+        vector<pair<string, int>> roadsA, roadsB;
+        for (auto [v, km] : a.adj[u]) roadsA.push_back({a.names[v], km});
+        for (auto [v, km] : b.adj[it->second]) roadsB.push_back({b.names[v], km});
+        sort(roadsA.begin(), roadsA.end());
+        sort(roadsB.begin(), roadsB.end());
+        if (roadsA != roadsB) return false;
+    }
+    return true;
+}
+
+int benchImport(int vertices, const string &directory) {
+    Graph original = buildSyntheticRoadGraph(vertices, 42);
+    string csvPath = directory + "/bench_roads.csv";
+    string edgePath = directory + "/bench_roads.edges";
+    string imagePath = directory + "/bench_roads.graph";
+    writeEdgeList(csvPath, original, false);
+    writeEdgeList(edgePath, original, true);
+    cout << "Synthetic graph: " << original.names.size() << " towns, CSV "
+         << formatFixed(filesystem::file_size(csvPath) / 1048576.0, 1) << " MiB, binary "
+         << formatFixed(filesystem::file_size(edgePath) / 1048576.0, 1) << " MiB\n";
+    cout << padRight("Loader", 30) << padRight("Seconds", 10) << "Check\n";
+
+    bool allOk = true;
+    auto report = [&](const string &name, double seconds, bool ok) {
+        cout << padRight(name, 30) << padRight(formatFixed(seconds, 3), 10) << (ok ? "ok" : "MISMATCH") << "\n";
+        allOk = allOk && ok;
+    };
+    double seconds;
+
+    auto t0 = chrono::steady_clock::now();
+    Graph lineByLine = loadCsvLineByLine(csvPath);
+    seconds = secondsSince(t0);
+    report("csv line by line", seconds, sameGraph(original, lineByLine, true));
+
+    t0 = chrono::steady_clock::now();
+    Graph fromCsv = buildGraphFromEdges(loadEdgeList(csvPath));
+    seconds = secondsSince(t0);
+    report("csv bulk (intern + 2 pass)", seconds, sameGraph(original, fromCsv, true));
+
+    t0 = chrono::steady_clock::now();
+    Graph fromBinary = buildGraphFromEdges(loadEdgeList(edgePath));
+    seconds = secondsSince(t0);
+    report("binary edge list", seconds, sameGraph(original, fromBinary));
+
+    t0 = chrono::steady_clock::now();
+    writeGraphImage(imagePath, fromBinary);
+    report("write graph image", secondsSince(t0), true);
+
+    // Opening the image plus one route query: the "start almost instantly" case
+    int s = original.indexOf.at("V0"), t = original.indexOf.at("V" + to_string(original.names.size() - 1));
+    t0 = chrono::steady_clock::now();
+    GraphImage image = GraphImage::open(imagePath);
+    double openS = secondsSince(t0);
+    int imageS = image.find("V0"), imageT = image.find("V" + to_string(original.names.size() - 1));
+    auto [km, route] = dijkstraOn(image, imageS, imageT);
+    double firstQueryS = secondsSince(t0);
+    report("open graph image", openS, imageS == s && imageT == t);
+    report("  + first route query", firstQueryS, km == original.dijkstraPath(s, t).first);
+
+    t0 = chrono::steady_clock::now();
+    Graph fromImage = image.toGraph();
+    seconds = secondsSince(t0);
+    report("graph image -> Graph", seconds, sameGraph(original, fromImage));
+
+    for (const string &path : {csvPath, edgePath, imagePath}) filesystem::remove(path);
+    return allOk ? 0 : 1;
+}
+
+// "--import FILE [image]": bulk-load an edge list, report it, optionally save a graph image
+int importCommand(const string &path, const string &imagePath) {
+    auto t0 = chrono::steady_clock::now();
+    EdgeList edges = loadEdgeList(path);
+    double parseS = secondsSince(t0);
+    size_t roads = edges.km.size();
+    t0 = chrono::steady_clock::now();
+    Graph G = buildGraphFromEdges(move(edges));
+    double buildS = secondsSince(t0);
+    cout << "Imported " << G.names.size() << " cities and " << roads << " roads (parse "
+         << formatFixed(parseS, 3) << " s, build " << formatFixed(buildS, 3) << " s)\n";
+    if (!imagePath.empty()) {
+        t0 = chrono::steady_clock::now();
+        writeGraphImage(imagePath, G);
+        cout << "Wrote graph image " << imagePath << " (" << formatFixed(secondsSince(t0), 3) << " s)\n";
+    }
+    return 0;
+}
+
+// "--route IMAGE FROM TO": shortest route straight from a mapped graph image
+int routeCommand(const string &imagePath, const string &fromName, const string &toName) {
+    auto t0 = chrono::steady_clock::now();
+    GraphImage image = GraphImage::open(imagePath);
+    int s = image.find(fromName), t = image.find(toName);
+    if (s < 0 || t < 0) {
+        cerr << "Error: unknown city " << (s < 0 ? fromName : toName) << "\n";
+        return 1;
+    }
+    auto [km, route] = dijkstraOn(image, s, t);
+    double seconds = secondsSince(t0);
+    if (km == INT_MAX) {
+        cout << "No path found between " << fromName << " and " << toName << ".\n";
+        return 0;
+    }
+    cout << "Path: ";
+    for (size_t i = 0; i < route.size(); ++i) {
+        cout << image.name(route[i]) << " (" << image.code(route[i]) << ")";
+        if (i + 1 != route.size()) cout << " -> ";
+    }
+    cout << "\nTotal distance: " << km << " km (" << formatFixed(seconds * 1000.0, 2) << " ms including open)\n";
+    return 0;
+}
+
+int benchPointToPoint(int vertices, int queries, int landmarkCount, unsigned seed) {
+    Graph G = buildSyntheticRoadGraph(vertices, seed, 0.001);
+    G.freeze(true);
+    const int n = (int)G.names.size();
+    cout << "Synthetic graph: " << n << " towns\n";
+
+    auto t0 = chrono::steady_clock::now();
+    RouteHeuristic straightLine = G.buildRouteHeuristic(true, 0);
+    double lineS = secondsSince(t0);
+    t0 = chrono::steady_clock::now();
+    RouteHeuristic landmarks = G.buildRouteHeuristic(false, landmarkCount);
+    double landmarkS = secondsSince(t0);
+    RouteHeuristic both = G.buildRouteHeuristic(true, landmarkCount);
+    cout << "Preprocessing: straight-line scale " << formatFixed(straightLine.kmPerChordUnit / RouteHeuristic::EARTH_RADIUS_KM, 3)
+         << " (" << formatFixed(lineS, 3) << " s), " << landmarkCount << " landmarks ("
+         << formatFixed(landmarkS, 3) << " s, " << formatFixed(landmarks.landmarkKm.size() * 4 / 1048576.0, 1) << " MiB)\n";
+
+    mt19937 rng(seed + 3);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<pair<int,int>> pairs(queries);
+    for (auto &[s, t] : pairs) { s = pick(rng); t = pick(rng); }
+
+    cout << padRight("Method", 30) << padRight("ms/query", 10) << padRight("settled/query", 15) << "Check\n";
+    vector<int> expected(queries);
+    using Search = function<pair<int, vector<int>>(int, int, SearchStats *)>;
+    vector<pair<string, Search>> methods = {
+        {"dijkstraPath", [&](int s, int t, SearchStats *st) { return G.dijkstraPath(s, t, st); }},
+        {"bidirectional dijkstra", [&](int s, int t, SearchStats *st) { return G.bidirectionalPath(s, t, st); }},
+        {"A* straight line", [&](int s, int t, SearchStats *st) { return G.aStarPath(s, t, straightLine, st); }},
+        {"A* landmarks", [&](int s, int t, SearchStats *st) { return G.aStarPath(s, t, landmarks, st); }},
+        {"A* straight line+landmarks", [&](int s, int t, SearchStats *st) { return G.aStarPath(s, t, both, st); }}};
+    for (size_t m = 0; m < methods.size(); ++m) {
+        SearchStats stats;
+        bool ok = true;
+        t0 = chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            auto [km, route] = methods[m].second(pairs[q].first, pairs[q].second, &stats);
+            if (m == 0) expected[q] = km;
+            ok = ok && km == expected[q];
+            // the route must really be that long
+            int length = 0;
+            for (size_t i = 0; ok && i + 1 < route.size(); ++i) {
+                int best = INT_MAX;
+                for (auto [v, w] : G.adj[route[i]]) if (v == route[i + 1]) best = min(best, w);
+                ok = best != INT_MAX;
+                length += ok ? best : 0;
+            }
+            ok = ok && (km == INT_MAX ? route.empty() : length == km && route.front() == pairs[q].first && route.back() == pairs[q].second);
+        }
+        double ms = secondsSince(t0) * 1000.0 / max(1, queries);
+        cout << padRight(methods[m].first, 30) << padRight(formatFixed(ms, 3), 10)
+             << padRight(to_string(stats.settled / max(1, queries)), 15) << (ok ? "ok" : "MISMATCH") << "\n";
+        if (!ok) return 1;
+    }
+    return 0;
+}
+
+// True if 'route' runs from s to t over real roads and is exactly 'km' long
+static bool isRouteOfLength(const Graph &G, const vector<int> &route, int s, int t, int km) {
+    if (km == INT_MAX) return route.empty();
+    if (route.empty() || route.front() != s || route.back() != t) return false;
+    long long length = 0;
+    for (size_t i = 0; i + 1 < route.size(); ++i) {
+        int best = INT_MAX;
+        for (auto [v, w] : G.adj[route[i]]) if (v == route[i + 1]) best = min(best, w);
+        if (best == INT_MAX) return false;
+        length += best;
+    }
+    return length == km;
+}
+
+int benchContractionHierarchy(int vertices, int threads, int queries, const string &file) {
+    Graph G = buildSyntheticRoadGraph(vertices, 42, 0.001);
+    G.freeze(true);
+    const int n = (int)G.names.size();
+    size_t roads = 0;
+    for (const auto &edges : G.adj) roads += edges.size();
+    cout << "Synthetic graph: " << n << " towns, " << roads / 2 << " roads\n";
+
+    auto t0 = chrono::steady_clock::now();
+    ContractionHierarchy ch = ContractionHierarchy::build(G.adj, threads);
+    double buildS = secondsSince(t0);
+    cout << "Preprocessing (" << threads << " threads): " << formatFixed(buildS, 2) << " s, "
+         << ch.shortcutCount << " shortcuts, " << ch.upArcs.size() << " upward arcs\n";
+
+    // Scaling: the same kind of graph at 1/16 and 1/4 of the size; the time per town should
+    // grow only slowly with the size
+    cout << padRight("Towns", 12) << padRight("Seconds", 10) << padRight("us/town", 10) << "shortcuts/town\n";
+    auto scalingRow = [&](int towns, double seconds, size_t shortcuts) {
+        cout << padRight(to_string(towns), 12) << padRight(formatFixed(seconds, 2), 10)
+             << padRight(formatFixed(seconds * 1e6 / max(1, towns), 1), 10)
+             << formatFixed((double)shortcuts / max(1, towns), 2) << "\n";
+    };
+    for (int smaller : {vertices / 16, vertices / 4}) {
+        if (smaller < 100) continue;
+        Graph S = buildSyntheticRoadGraph(smaller, 42, 0.001);
+        t0 = chrono::steady_clock::now();
+        ContractionHierarchy sch = ContractionHierarchy::build(S.adj, threads);
+        scalingRow((int)S.names.size(), secondsSince(t0), sch.shortcutCount);
+    }
+    scalingRow(n, buildS, ch.shortcutCount);
+
+    if (!file.empty()) {
+        t0 = chrono::steady_clock::now();
+        ch.save(file);
+        double saveS = secondsSince(t0);
+        t0 = chrono::steady_clock::now();
+        ch = ContractionHierarchy::load(file);
+        cout << "Saved " << file << " (" << formatFixed(filesystem::file_size(file) / 1048576.0, 1) << " MiB) in "
+             << formatFixed(saveS, 3) << " s, loaded in " << formatFixed(secondsSince(t0), 3) << " s\n";
+    }
+
+    mt19937 rng(11);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<pair<int,int>> pairs(queries);
+    for (auto &[s, t] : pairs) { s = pick(rng); t = pick(rng); }
+
+    SearchStats dijkstraStats, chStats;
+    vector<int> expected(queries);
+    t0 = chrono::steady_clock::now();
+    for (int q = 0; q < queries; ++q) expected[q] = G.dijkstraPath(pairs[q].first, pairs[q].second, &dijkstraStats).first;
+    double dijkstraUs = secondsSince(t0) * 1e6 / max(1, queries);
+
+    ContractionHierarchy::Query query(ch);
+    int wrong = 0;
+    t0 = chrono::steady_clock::now();
+    for (int q = 0; q < queries; ++q) wrong += query.distance(pairs[q].first, pairs[q].second, &chStats) != expected[q];
+    double chUs = secondsSince(t0) * 1e6 / max(1, queries);
+
+    t0 = chrono::steady_clock::now();
+    for (int q = 0; q < queries; ++q) {
+        auto [km, route] = query.route(pairs[q].first, pairs[q].second);
+        wrong += !isRouteOfLength(G, route, pairs[q].first, pairs[q].second, expected[q]) || km != expected[q];
+    }
+    double routeUs = secondsSince(t0) * 1e6 / max(1, queries);
+
+    cout << padRight("Method", 26) << padRight("us/query", 12) << "settled/query\n";
+    cout << padRight("dijkstraPath", 26) << padRight(formatFixed(dijkstraUs, 1), 12) << dijkstraStats.settled / max(1, queries) << "\n";
+    cout << padRight("CH distance", 26) << padRight(formatFixed(chUs, 1), 12) << chStats.settled / max(1, queries) << "\n";
+    cout << padRight("CH route (unpacked)", 26) << padRight(formatFixed(routeUs, 1), 12) << "\n";
+    cout << (wrong == 0 ? "All " + to_string(queries) + " queries match dijkstraPath\n"
+                        : to_string(wrong) + " MISMATCHES\n");
+
+    // Zero-km roads: every pair on small random graphs, route and distance
+    int zeroWrong = 0;
+    const int zeroGraphs = 100;
+    for (int g = 0; g < zeroGraphs; ++g) {
+        Graph Z = buildZeroKmTestGraph(40, 1000 + g);
+        ContractionHierarchy zch = ContractionHierarchy::build(Z.adj, threads);
+        ContractionHierarchy::Query zq(zch);
+        for (int s = 0; s < 40; ++s) {
+            for (int t = 0; t < 40; ++t) {
+                int km = Z.dijkstraPath(s, t).first;
+                auto [chKm, route] = zq.route(s, t);
+                zeroWrong += chKm != km || zq.distance(s, t) != km || !isRouteOfLength(Z, route, s, t, km);
+            }
+        }
+    }
+    cout << "Zero-km roads (" << zeroGraphs << " graphs x 40 towns, all pairs): "
+         << (zeroWrong == 0 ? string("ok") : to_string(zeroWrong) + " MISMATCHES") << "\n";
+    return wrong == 0 && zeroWrong == 0 ? 0 : 1;
+}
+
+// Every Dijkstra queue on road graphs of N/16, N/4 and N towns: point-to-point and full searches
+int benchQueues(int vertices, int queries, unsigned seed) {
+    const vector<QueueKind> kinds = {QueueKind::BinaryHeap, QueueKind::FourAryHeap, QueueKind::RadixHeap, QueueKind::Dial};
+    const int fullSearches = 8;
+    bool allOk = true;
+    for (int size : {vertices / 16, vertices / 4, vertices}) {
+        if (size < 2) continue;
+        Graph G = buildSyntheticRoadGraph(size, seed, 0.001);
+        G.freeze(true);
+        const int n = (int)G.names.size();
+        int longest = 0;
+        for (const auto &edges : G.adj) for (auto [v, km] : edges) longest = max(longest, km);
+        cout << "Synthetic graph: " << n << " towns, longest road " << longest << " km\n";
+
+        mt19937 rng(seed + 5);
+        uniform_int_distribution<int> pick(0, n - 1);
+        vector<pair<int,int>> pairs(queries);
+        for (auto &[s, t] : pairs) { s = pick(rng); t = pick(rng); }
+        vector<int> sources(fullSearches);
+        for (int &s : sources) s = pick(rng);
+
+        cout << "  " << padRight("Queue", 22) << padRight("p2p ms/query", 15) << padRight("full ms/search", 17) << "Check\n";
+        vector<int> expectedKm(queries);
+        vector<vector<int>> expectedDist(fullSearches);
+        for (QueueKind kind : kinds) {
+            G.dijkstraQueue = kind;
+            bool ok = true;
+            auto t0 = chrono::steady_clock::now();
+            for (int q = 0; q < queries; ++q) {
+                auto [km, route] = G.dijkstraPath(pairs[q].first, pairs[q].second);
+                if (kind == kinds[0]) expectedKm[q] = km;
+                ok = ok && km == expectedKm[q] && isRouteOfLength(G, route, pairs[q].first, pairs[q].second, km);
+            }
+            double p2pMs = secondsSince(t0) * 1000.0 / max(1, queries);
+
+            t0 = chrono::steady_clock::now();
+            for (int i = 0; i < fullSearches; ++i) {
+                vector<int> dist = G.shortestDistances(sources[i]);
+                if (kind == kinds[0]) expectedDist[i] = move(dist);
+                else ok = ok && dist == expectedDist[i];
+            }
+            double fullMs = secondsSince(t0) * 1000.0 / fullSearches;
+
+            cout << "  " << padRight(queueKindName(kind), 22) << padRight(formatFixed(p2pMs, 3), 15)
+                 << padRight(formatFixed(fullMs, 2), 17) << (ok ? "ok" : "MISMATCH") << "\n";
+            allOk = allOk && ok;
+        }
+    }
+    return allOk ? 0 : 1;
+}
+
+// Depot x drop-point distance matrices: single queries vs one tree per depot vs CH buckets
+int benchBatch(int vertices, int depots, int drops, int threads) {
+    Graph G = buildSyntheticRoadGraph(vertices, 42, 0.001);
+    G.freeze(true);
+    const int n = (int)G.names.size();
+    mt19937 rng(17);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<int> sources(depots), targets(drops);
+    for (int &v : sources) v = pick(rng);
+    for (int &v : targets) v = pick(rng);
+    cout << "Synthetic graph: " << n << " towns; " << depots << " depots x " << drops << " drop points, "
+         << threads << " threads\n";
+
+    // One dijkstraPath per cell would take too long; time a sample and scale it up
+    const int sample = min(depots * drops, 200);
+    auto t0 = chrono::steady_clock::now();
+    vector<int> sampleKm(sample);
+    for (int q = 0; q < sample; ++q) sampleKm[q] = G.dijkstraPath(sources[q % depots], targets[q / depots % drops]).first;
+    double singleS = secondsSince(t0) / max(1, sample) * depots * drops;
+
+    t0 = chrono::steady_clock::now();
+    DistanceMatrix trees = G.distanceMatrix(sources, targets, threads);
+    double treesS = secondsSince(t0);
+
+    t0 = chrono::steady_clock::now();
+    ContractionHierarchy ch = ContractionHierarchy::build(G.adj, threads);
+    double buildS = secondsSince(t0);
+    t0 = chrono::steady_clock::now();
+    DistanceMatrix buckets = ch.manyToMany(sources, targets, threads);
+    double bucketsS = secondsSince(t0);
+
+    bool ok = trees == buckets;
+    for (int q = 0; q < sample; ++q) {
+        int km = trees.at(q % depots, q / depots % drops);
+        ok = ok && (km < DistanceMatrix::INF ? km : INT_MAX) == sampleKm[q];
+    }
+    cout << padRight("Method", 34) << "Seconds\n";
+    cout << padRight("dijkstraPath per cell (estimated)", 34) << formatFixed(singleS, 3) << "\n";
+    cout << padRight("distanceMatrix (tree per depot)", 34) << formatFixed(treesS, 3) << "\n";
+    cout << padRight("CH manyToMany (buckets)", 34) << formatFixed(bucketsS, 3)
+         << " (+ " << formatFixed(buildS, 2) << " s preprocessing)\n";
+    cout << (ok ? "Matrices match each other and dijkstraPath\n" : "MISMATCH\n");
+
+    // Zero-km roads: full matrices on small random graphs against dijkstraPath
+    int zeroWrong = 0;
+    const int zeroGraphs = 100;
+    for (int g = 0; g < zeroGraphs; ++g) {
+        Graph Z = buildZeroKmTestGraph(40, 2000 + g);
+        vector<int> all(40);
+        iota(all.begin(), all.end(), 0);
+        DistanceMatrix zTrees = Z.distanceMatrix(all, all, threads);
+        DistanceMatrix zBuckets = ContractionHierarchy::build(Z.adj, threads).manyToMany(all, all, threads);
+        for (int s = 0; s < 40; ++s) {
+            for (int t = 0; t < 40; ++t) {
+                int km = Z.dijkstraPath(s, t).first;
+                int expected = km == INT_MAX ? DistanceMatrix::INF : km;
+                zeroWrong += zTrees.at(s, t) != expected || zBuckets.at(s, t) != expected;
+            }
+        }
+    }
+    cout << "Zero-km roads (" << zeroGraphs << " graphs x 40 towns, all pairs): "
+         << (zeroWrong == 0 ? string("ok") : to_string(zeroWrong) + " MISMATCHES") << "\n";
+    return ok && zeroWrong == 0 ? 0 : 1;
+}
+
+// Dispatches "--bench-..." command lines; returns the process exit code
+int runCommandLine(int argc, char *argv[]) {
+    vector<string> args(argv + 1, argv + argc);
+    auto intArg = [&](size_t i, int fallback) {
+        return i < args.size() ? stoi(args[i]) : fallback;
+    };
+    try {
+        if (args[0] == "--bench-csr" && args.size() >= 2) {
+            return benchCsr(intArg(1, 0), intArg(2, 20), (unsigned)intArg(3, 42));
+        }
+        if (args[0] == "--bench-bfs" && args.size() >= 2) {
+            int hardware = max(1, (int)thread::hardware_concurrency());
+            return benchBfs(intArg(1, 0), intArg(2, hardware), intArg(3, 10), (unsigned)intArg(4, 42));
+        }
+        if (args[0] == "--bench-import" && args.size() >= 2) {
+            return benchImport(intArg(1, 0), args.size() > 2 ? args[2] : filesystem::temp_directory_path().string());
+        }
+        if (args[0] == "--import" && args.size() >= 2) {
+            return importCommand(args[1], args.size() > 2 ? args[2] : "");
+        }
+        if (args[0] == "--route" && args.size() == 4) {
+            return routeCommand(args[1], args[2], args[3]);
+        }
+        if (args[0] == "--export-synthetic" && args.size() == 3) {
+            const string &path = args[2];
+            bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+            writeEdgeList(path, buildSyntheticRoadGraph(intArg(1, 0), 42), !csv);
+            return 0;
+        }
+        if (args[0] == "--bench-p2p" && args.size() >= 2) {
+            return benchPointToPoint(intArg(1, 0), intArg(2, 100), intArg(3, 8), (unsigned)intArg(4, 42));
+        }
+        if (args[0] == "--bench-ch" && args.size() >= 2) {
+            int hardware = max(1, (int)thread::hardware_concurrency());
+            return benchContractionHierarchy(intArg(1, 0), intArg(2, hardware), intArg(3, 1000), args.size() > 4 ? args[4] : "");
+        }
+        if (args[0] == "--bench-queues" && args.size() >= 2) {
+            return benchQueues(intArg(1, 0), intArg(2, 200), (unsigned)intArg(3, 42));
+        }
+        if (args[0] == "--bench-batch" && args.size() >= 2) {
+            int hardware = max(1, (int)thread::hardware_concurrency());
+            return benchBatch(intArg(1, 0), intArg(2, 100), intArg(3, 1000), intArg(4, hardware));
+        }
+        if (args[0] == "--bench-apsp" && args.size() >= 2) {
+            int hardware = max(1, (int)thread::hardware_concurrency());
+            return benchApsp(intArg(1, 0), intArg(2, hardware), args.size() > 3 ? args[3] : "");
+        }
+    } catch (const exception &e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    cerr << "Usage: " << argv[0] << "                                (interactive menu)\n"
+         << "       " << argv[0] << " --bench-csr N [queries] [seed]\n"
+         << "       " << argv[0] << " --bench-bfs N [threads] [queries] [seed]\n"
+         << "       " << argv[0] << " --bench-apsp N [threads] [table-file]\n"
+         << "       " << argv[0] << " --bench-import N [dir]\n"
+         << "       " << argv[0] << " --bench-p2p N [queries] [landmarks] [seed]\n"
+         << "       " << argv[0] << " --bench-ch N [threads] [queries] [file]\n"
+         << "       " << argv[0] << " --bench-queues N [queries] [seed]\n"
+         << "       " << argv[0] << " --bench-batch N [depots] [drop-points] [threads]\n"
+         << "       " << argv[0] << " --import EDGES(.csv|binary) [graph-image]\n"
+         << "       " << argv[0] << " --route GRAPH-IMAGE FROM TO\n"
+         << "       " << argv[0] << " --export-synthetic N FILE(.csv|other = binary)\n";
+    return 1;
+}
+
 // ------------------------------ Program Entry ----------------------------------
 
-int main() {
+int main(int argc, char *argv[]) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    if (argc > 1) return runCommandLine(argc, argv);
+
     Graph G = buildSampleGraph();
 
     cout << "==================== Transport Connectivity Tool ====================\n";
@@ -303,12 +3331,16 @@ int main() {
     G.printSummary();
     G.printAdjacencyMatrix();
 
+    // All shortest distances up front: menu routing below is then a table lookup
+    DistanceTable table = G.allPairsDistances();
+
     // Interactive mini-menu (simple and clear)
     while (true) {
         cout << "Choose an option:\n";
         cout << "  1) BFS traversal from a city (reachability order)\n";
         cout << "  2) Dijkstra shortest path between two cities\n";
         cout << "  3) Show graph summary & adjacency matrix again\n";
+        cout << "  4) Show shortest distances between all cities\n";
         cout << "  0) Exit\n";
         cout << "Enter choice: ";
         int choice;
@@ -353,7 +3385,9 @@ int main() {
                 continue;
             }
 
-            auto [bestKm, route] = G.dijkstraPath(src, dst);
+            int s = G.indexOf.at(src), t = G.indexOf.at(dst);
+            int bestKm = table.reachable(s, t) ? table.at(s, t) : INT_MAX;
+            vector<int> route = G.routeFromTable(table, s, t);
             if (bestKm == INT_MAX || route.empty()) {
                 cout << "No path found between " << src << " and " << dst << ".\n\n";
                 continue;
@@ -365,6 +3399,8 @@ int main() {
         } else if (choice == 3) {
             G.printSummary();
             G.printAdjacencyMatrix();
+        } else if (choice == 4) {
+            G.printDistanceTable(table);
         } else {
             cout << "Invalid choice. Please try again.\n\n";
         }
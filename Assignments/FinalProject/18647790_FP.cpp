@@ -10,10 +10,11 @@ using namespace std;
    Data Structures Overview
    ===========================
    - Graph stored as adjacency list: unordered_map<string, vector<edge>>
+   - Node ids assigned once on first sight, with an id-indexed copy of the arcs for Dijkstra
    - Edge list also kept in a set (sorted by (from,to)) for quick existence checks
    - History stacks (undo/redo) implemented with std::stack
    - Vectors + custom functors for sorting routes by distance/time
-   - Priority queue for Dijkstra
+   - Priority queue for Dijkstra (lazy binary heap or indexed 4-ary heap, selectable)
 */
 
 struct Edge {
@@ -42,12 +43,71 @@ struct ByTime {
     }
 };
 
+// Which min-priority queue Dijkstra uses (both give the same shortest times)
+enum class QueueKind { BinaryHeap, FourAryHeap };
+
+// std::priority_queue with lazy deletion: an improved node is pushed again and the
+// outdated copy is skipped when popped (simple, but the heap grows with every update)
+struct LazyBinaryHeap {
+    priority_queue<pair<double,int>, vector<pair<double,int>>, greater<pair<double,int>>> pq;
+    explicit LazyBinaryHeap(int n) { (void)n; }
+    bool empty() const { return pq.empty(); }
+    void push(double d, int v) { pq.push({d, v}); }
+    pair<double,int> pop() { auto top = pq.top(); pq.pop(); return top; }
+};
+
+// Indexed 4-ary heap: pos[v] remembers where node v sits, so an improved time lowers
+// its single entry in place (decrease-key). No stale entries, and a shallower tree.
+struct IndexedFourAryHeap {
+    vector<pair<double,int>> heap; // (time, node id)
+    vector<int> pos;               // node id -> index in heap, -1 if not queued
+    explicit IndexedFourAryHeap(int n) : pos(n, -1) {}
+    bool empty() const { return heap.empty(); }
+
+    void push(double d, int v) {
+        int i = pos[v];
+        if (i < 0) { i = (int)heap.size(); heap.push_back({d, v}); }
+        else if (d < heap[i].first) heap[i].first = d;
+        else return;
+        // sift up
+        auto item = heap[i];
+        while (i > 0 && heap[(i-1)/4].first > item.first) {
+            heap[i] = heap[(i-1)/4]; pos[heap[i].second] = i; i = (i-1)/4;
+        }
+        heap[i] = item; pos[item.second] = i;
+    }
+
+    pair<double,int> pop() {
+        auto top = heap[0];
+        pos[top.second] = -1;
+        auto item = heap.back(); heap.pop_back();
+        if (heap.empty()) return top;
+        // sift the last entry down from the root
+        int i = 0, n = (int)heap.size();
+        while (4*i + 1 < n) {
+            int best = 4*i + 1;
+            for (int c = best + 1; c < min(4*i + 5, n); ++c) if (heap[c].first < heap[best].first) best = c;
+            if (heap[best].first >= item.first) break;
+            heap[i] = heap[best]; pos[heap[i].second] = i; i = best;
+        }
+        heap[i] = item; pos[item.second] = i;
+        return top;
+    }
+};
+
 class Graph {
 private:
     unordered_map<string, vector<Edge>> adj;         // adjacency list
     set<pair<string,string>> edgeIndex;              // quick membership check
     set<string> nodes;                               // all unique nodes
 
+    // Dijkstra's view of the same graph: every node gets an id once, when first seen, and
+    // arcs[id] mirrors adj[name] with target ids, so a query never hashes a name per edge
+    struct Arc { int to; double distanceKm, baseMinutes; };
+    unordered_map<string, int> idOf;
+    vector<string> nameOf;
+    vector<vector<Arc>> arcs;
+
     // History for undo/redo
     enum class OpType { ADD, REMOVE, UPDATE };
     struct Op {
@@ -58,6 +118,9 @@ private:
     };
     stack<Op> undoStack, redoStack;
 
+    QueueKind queueKind = QueueKind::BinaryHeap; // Dijkstra's priority queue
+    bool detailedTrace = true;                   // per-node XAI lines (off for benchmarks)
+
     // Simple "AI-like" congestion multiplier based on hour of day (0..23)
     // WHY: I make traffic higher in peak hours; document the rule clearly for transparency.
     double congestionMultiplier(int hour) const {
@@ -71,9 +134,7 @@ public:
     bool addRoute(const string& from, const string& to, double dist, double mins) {
         if (dist <= 0 || mins <= 0) return false;
         if (edgeIndex.count({from,to})) return false; // already exists
-        adj[from].push_back(Edge(to, dist, mins));
-        edgeIndex.insert({from,to});
-        nodes.insert(from); nodes.insert(to);
+        addInternal(from, to, dist, mins);
 
         // Record history
         undoStack.push({OpType::ADD, from, to, 0,0, dist, mins});
@@ -94,6 +155,7 @@ public:
 
                 vec.erase(vec.begin()+i);
                 edgeIndex.erase({from,to});
+                syncArcs(from);
                 return true;
             }
         }
@@ -112,6 +174,7 @@ public:
 
                 e.distanceKm = newDist;
                 e.baseMinutes = newMins;
+                syncArcs(from);
                 return true;
             }
         }
@@ -162,6 +225,8 @@ public:
             adj[from].push_back(Edge(to,d,m));
             edgeIndex.insert({from,to});
             nodes.insert(from); nodes.insert(to);
+            nodeId(to);
+            arcs[nodeId(from)].push_back({idOf[to], d, m});
         }
     }
     void removeInternal(const string& from, const string& to) {
@@ -169,10 +234,12 @@ public:
         auto &vec = adj[from];
         for (size_t i=0;i<vec.size();++i) if (vec[i].to==to) { vec.erase(vec.begin()+i); break; }
         edgeIndex.erase({from,to});
+        syncArcs(from);
     }
     void updateInternal(const string& from, const string& to, double d, double m) {
         auto &vec = adj[from];
-        for (auto& e : vec) if (e.to==to){ e.distanceKm=d; e.baseMinutes=m; return; }
+        for (auto& e : vec) if (e.to==to){ e.distanceKm=d; e.baseMinutes=m; break; }
+        syncArcs(from);
     }
 
     void listAllRoutesSortedBy(const string& from, bool byTime) const {
@@ -214,25 +281,62 @@ public:
     vector<string> shortestPath(const string& src, const string& dst, bool useCongestion, int hour,
                                 double& outTotalMinutes, double& outTotalDistance,
                                 vector<string>& xaiTrace) const
+    {
+        if (queueKind == QueueKind::FourAryHeap) {
+            return shortestPathWith<IndexedFourAryHeap>(src, dst, useCongestion, hour, outTotalMinutes, outTotalDistance, xaiTrace);
+        }
+        return shortestPathWith<LazyBinaryHeap>(src, dst, useCongestion, hour, outTotalMinutes, outTotalDistance, xaiTrace);
+    }
+
+    void setQueueKind(QueueKind kind) { queueKind = kind; }
+    void setDetailedTrace(bool on) { detailedTrace = on; }
+
+    bool routeExists(const string& from, const string& to) const {
+        return edgeIndex.count({from,to});
+    }
+
+private:
+    // Id of a node name, handing out the next id (and an empty arc list) the first time
+    int nodeId(const string& name) {
+        auto [it, added] = idOf.emplace(name, (int)nameOf.size());
+        if (added) { nameOf.push_back(name); arcs.emplace_back(); }
+        return it->second;
+    }
+
+    // Rebuilds the arcs of one node after an edit of adj[from] (same order as adj)
+    void syncArcs(const string& from) {
+        auto &out = arcs[nodeId(from)];
+        out.clear();
+        for (auto &e : adj[from]) out.push_back({idOf.at(e.to), e.distanceKm, e.baseMinutes});
+    }
+
+    // Dijkstra itself; Queue is LazyBinaryHeap or IndexedFourAryHeap.
+    // Runs on the id-indexed arcs, so a query only allocates its per-node arrays and queue.
+    template <class Queue>
+    vector<string> shortestPathWith(const string& src, const string& dst, bool useCongestion, int hour,
+                                    double& outTotalMinutes, double& outTotalDistance,
+                                    vector<string>& xaiTrace) const
     {
         xaiTrace.clear();
         const double INF = 1e18;
-        unordered_map<string, double> dist;    // minutes cost
-        unordered_map<string, double> distKm;  // track distance for explanation
-        unordered_map<string, string> parent;
-        struct Node { double d; string v; };
-        struct Cmp { bool operator()(const Node& a, const Node& b) const { return a.d > b.d; } };
-        priority_queue<Node, vector<Node>, Cmp> pq;
-
-        // Init
-        for (auto &n : nodes) { dist[n]=INF; distKm[n]=0; }
-        if (!nodes.count(src) || !nodes.count(dst)) {
+        auto srcId = idOf.find(src), dstId = idOf.find(dst);
+        if (srcId == idOf.end() || dstId == idOf.end()) {
             xaiTrace.push_back("Either source or destination does not exist in the graph.");
             outTotalMinutes = outTotalDistance = INF;
             return {};
         }
-        dist[src]=0; distKm[src]=0; parent[src]="";
-        pq.push({0, src});
+
+        // Init
+        const vector<string>& name = nameOf;
+        const int n = (int)name.size();
+        vector<double> dist(n, INF);    // minutes cost
+        vector<double> distKm(n, 0);    // track distance for explanation
+        vector<int> parent(n, -1);
+        Queue pq(n);
+
+        const int s = srcId->second, t = dstId->second;
+        dist[s]=0;
+        pq.push(0, s);
         xaiTrace.push_back("Start at " + src + " with initial cost 0.");
 
         double mult = useCongestion ? congestionMultiplier(hour) : 1.0;
@@ -245,31 +349,30 @@ public:
 
         // Dijkstra
         while (!pq.empty()) {
-            auto [cd, u] = pq.top(); pq.pop();
-            if (cd != dist[u]) continue; // skip stale entry
+            auto [cd, u] = pq.pop();
+            if (cd != dist[u]) continue; // skip stale entry (only the lazy heap has them)
 
             // Node selection rationale
-            xaiTrace.push_back("Selecting node " + u + " next because it currently has the smallest known travel time (" + to_string(cd) + " min).");
+            if (detailedTrace) xaiTrace.push_back("Selecting node " + name[u] + " next because it currently has the smallest known travel time (" + to_string(cd) + " min).");
 
-            if (u == dst) break; // early exit possible
+            if (u == t) break; // early exit possible
 
-            auto it = adj.find(u);
-            if (it == adj.end()) continue;
-            for (auto &e : it->second) {
+            for (auto &e : arcs[u]) {
+                int v = e.to;
                 double w = e.baseMinutes * mult; // effective time
                 double nd = dist[u] + w;
-                if (nd < dist[e.to]) {
-                    dist[e.to] = nd;
-                    distKm[e.to] = distKm[u] + e.distanceKm;
-                    parent[e.to] = u;
-                    pq.push({nd, e.to});
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    distKm[v] = distKm[u] + e.distanceKm;
+                    parent[v] = u;
+                    pq.push(nd, v);
                     // Relaxation explanation
-                    xaiTrace.push_back("Updated best time to " + e.to + " via " + u + " to " + to_string(nd) + " min (distance so far " + to_string(distKm[e.to]) + " km).");
+                    if (detailedTrace) xaiTrace.push_back("Updated best time to " + name[v] + " via " + name[u] + " to " + to_string(nd) + " min (distance so far " + to_string(distKm[v]) + " km).");
                 }
             }
         }
 
-        if (dist[dst] >= INF/2) {
+        if (dist[t] >= INF/2) {
             xaiTrace.push_back("No path found from " + src + " to " + dst + ".");
             outTotalMinutes = outTotalDistance = INF;
             return {};
@@ -277,21 +380,17 @@ public:
 
         // Reconstruct path
         vector<string> path;
-        for (string v = dst; !v.empty(); v = parent[v]) path.push_back(v);
+        for (int v = t; v != -1; v = parent[v]) path.push_back(name[v]);
         reverse(path.begin(), path.end());
 
-        outTotalMinutes = dist[dst];
-        outTotalDistance = distKm[dst];
+        outTotalMinutes = dist[t];
+        outTotalDistance = distKm[t];
 
         // Final justification
         xaiTrace.push_back("Shortest path found using Dijkstra. Nodes visited are those selected with smallest known times.");
         xaiTrace.push_back("Total cost: " + to_string(outTotalMinutes) + " minutes; Total distance: " + to_string(outTotalDistance) + " km.");
         return path;
     }
-
-    bool routeExists(const string& from, const string& to) const {
-        return edgeIndex.count({from,to});
-    }
 };
 
 void seedDemoData(Graph& g) {
@@ -306,6 +405,57 @@ void seedDemoData(Graph& g) {
     g.addRoute("University","Airport", 8.0, 16.0);
 }
 
+// A side x side street grid ("I0".."In-1") with two-way roads of random length and speed
+void seedGridCity(Graph& g, int nodes, unsigned seed) {
+    int side = max(2, (int)sqrt((double)nodes));
+    mt19937 rng(seed);
+    uniform_real_distribution<double> km(0.3, 2.0), kmh(20.0, 80.0);
+    auto link = [&](int a, int b) {
+        double d = km(rng), m = d / kmh(rng) * 60.0;
+        g.addRoute("I" + to_string(a), "I" + to_string(b), d, m);
+        g.addRoute("I" + to_string(b), "I" + to_string(a), d, m);
+    };
+    for (int r=0;r<side;++r) for (int c=0;c<side;++c) {
+        if (c+1 < side) link(r*side + c, r*side + c + 1);
+        if (r+1 < side) link(r*side + c, (r+1)*side + c);
+    }
+}
+
+// Times both Dijkstra queues on grid cities of about n/16, n/4 and n intersections
+int benchQueues(int n, int queries) {
+    bool allOk = true;
+    for (int size : {n/16, n/4, n}) {
+        if (size < 4) continue;
+        Graph g;
+        seedGridCity(g, size, 42);
+        g.setDetailedTrace(false);
+        int side = max(2, (int)sqrt((double)size));
+        mt19937 rng(7);
+        uniform_int_distribution<int> pick(0, side*side - 1);
+        vector<pair<string,string>> pairs(queries);
+        for (auto& q : pairs) { q.first = "I" + to_string(pick(rng)); q.second = "I" + to_string(pick(rng)); }
+
+        cout << "Grid city: " << side*side << " intersections\n";
+        vector<double> expected(queries);
+        for (QueueKind kind : {QueueKind::BinaryHeap, QueueKind::FourAryHeap}) {
+            g.setQueueKind(kind);
+            bool ok = true;
+            auto t0 = chrono::steady_clock::now();
+            for (int q=0;q<queries;++q) {
+                double mins, km; vector<string> xai;
+                g.shortestPath(pairs[q].first, pairs[q].second, false, 12, mins, km, xai);
+                if (kind == QueueKind::BinaryHeap) expected[q] = mins;
+                ok = ok && fabs(mins - expected[q]) < 1e-9;
+            }
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count() / max(1, queries);
+            cout << "  " << (kind == QueueKind::BinaryHeap ? "binary heap (lazy)   " : "indexed 4-ary heap   ")
+                 << fixed << setprecision(3) << ms << " ms/query  " << (ok ? "ok" : "MISMATCH") << "\n";
+            allOk = allOk && ok;
+        }
+    }
+    return allOk ? 0 : 1;
+}
+
 void printMenu() {
     cout << "\n===== SMART CITY ROUTE MANAGEMENT =====\n";
     cout << "1. Add a route\n";
@@ -322,10 +472,15 @@ void printMenu() {
     cout << "Select: ";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    // Benchmark mode: compare Dijkstra's priority queues instead of running the menu
+    if (argc >= 3 && string(argv[1]) == "--bench-queues") {
+        return benchQueues(atoi(argv[2]), argc >= 4 ? atoi(argv[3]) : 100);
+    }
+
     Graph g;
     seedDemoData(g);
 
@@ -445,6 +600,9 @@ int main() {
    - set<pair<string,string>>: Keeps a canonical index of existing routes, enabling quick existence checks and preventing duplicates.
    - vector<Edge> + custom functors (ByDistance, ByTime): Supports sorting by different criteria (distance vs time).
    - priority_queue for Dijkstra: Efficiently selects next node with smallest known cost.
+     Two versions (setQueueKind): a lazy binary heap that re-pushes improved nodes, and an
+     indexed 4-ary heap that lowers a node's entry in place (decrease-key) so nothing goes stale.
+     "--bench-queues N [queries]" times both on street grids of N/16, N/4 and N intersections.
    - stack<Op> for undo/redo: Provides simple, LIFO history of edits (add/remove/update).
 
    Graph Algorithm: